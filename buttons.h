@@ -1,29 +1,137 @@
 #ifndef BUTTONS_H
 #define BUTTONS_H
 
-#include <JC_Button.h> // https://github.com/JChristensen/JC_Button
+#include "config.h"
+#include "control_mode_structs.h"
 
-Button middleButton(MIDDLE_PIN);
-Button upButton(UP_PIN);
-Button downButton(DOWN_PIN);
-Button leftButton(LEFT_PIN);
-Button rightButton(RIGHT_PIN);
+/*
+Button debouncing, for all the buttons at once. Every BUTTON_SAMPLE_TIME the
+button pins are sampled together, a bit per BUTTON_*. The first sample that
+differs from a button's debounced state changes it at once, so a press or
+release is seen within one BUTTON_SAMPLE_TIME of its first contact. The
+button is then locked out for the next BUTTON_DEBOUNCE_SAMPLES samples, by a
+vertical counter (a 2-bit counter per button, kept as one byte of low bits
+and one of high bits) counting down, so the bouncing that follows an edge is
+ignored. The price is that a glitch on an idle line also counts as an edge.
+
+On the 32u4 boards in mcu.h the pins are read straight from the input port
+registers; elsewhere, including HOST_SIMULATION, with digitalRead().
+debounceButtons() only works on a sample, so it can be fed made-up ones.
+*/
+
+static_assert(NUMBER_OF_BUTTONS <= 8, "the button masks hold 8 buttons");
+
+// fixed by the 2-bit counters, which count down from 3
+#define BUTTON_DEBOUNCE_SAMPLES 3
+
+const uint8_t buttonPins[NUMBER_OF_BUTTONS] = {
+  MIDDLE_PIN, UP_PIN, DOWN_PIN, LEFT_PIN, RIGHT_PIN
+};
+
+uint8_t buttonsDebounced = 0; // the buttons that are down, a bit per BUTTON_*
+uint8_t buttonCountLow = 0; // the vertical counter: lockout samples left
+uint8_t buttonCountHigh = 0;
+unsigned long lastButtonSample = 0;
+
+/* The buttons that went down and came up in the last readButtons(), a bit
+   per BUTTON_*, so the rest of the loop only looks at buttons that changed */
+uint8_t buttonsPressed = 0;
+uint8_t buttonsReleased = 0;
+
+/* One of the buttons, as seen by the last readButtons(); the same calls as
+   JC_Button, which this replaces */
+class Button {
+public:
+  Button(uint8_t button) : mask(1 << button) {}
+  bool isPressed() const { return buttonsDebounced & mask; }
+  bool wasPressed() const { return buttonsPressed & mask; }
+  bool wasReleased() const { return buttonsReleased & mask; }
+private:
+  const uint8_t mask;
+};
+
+Button middleButton(BUTTON_MIDDLE);
+Button upButton(BUTTON_UP);
+Button downButton(BUTTON_DOWN);
+Button leftButton(BUTTON_LEFT);
+Button rightButton(BUTTON_RIGHT);
+
+// indexed by BUTTON_*; a new button only needs adding here, to buttonPins and to BUTTON_*
+Button * const buttons[NUMBER_OF_BUTTONS] = {
+  &middleButton, &upButton, &downButton, &leftButton, &rightButton
+};
+
+#if (defined(ARDUINO_MICRO) || defined(SPARKFUN_PRO_MICRO)) && !defined(HOST_SIMULATION)
+static_assert((MIDDLE_PIN == 7) && (UP_PIN == 10) && (DOWN_PIN == 4) && (LEFT_PIN == 5) && (RIGHT_PIN == 6),
+              "readButtonPins() reads the button pins of mcu.h from their ports");
+
+/* The buttons that are down, a bit per BUTTON_*, from one read of each port
+   they are on: 7 is PE6, 10 is PB6, 4 is PD4, 5 is PC6 and 6 is PD7. The
+   pins are pulled up, so a pressed button reads low. */
+uint8_t readButtonPins() {
+  uint8_t portB = ~PINB;
+  uint8_t portC = ~PINC;
+  uint8_t portD = ~PIND;
+  uint8_t portE = ~PINE;
+
+  uint8_t pins = 0;
+  if (portE & _BV(6)) pins |= _BV(BUTTON_MIDDLE);
+  if (portB & _BV(6)) pins |= _BV(BUTTON_UP);
+  if (portD & _BV(4)) pins |= _BV(BUTTON_DOWN);
+  if (portC & _BV(6)) pins |= _BV(BUTTON_LEFT);
+  if (portD & _BV(7)) pins |= _BV(BUTTON_RIGHT);
+  return pins;
+}
+#else
+uint8_t readButtonPins() {
+  uint8_t pins = 0;
+  for (uint8_t b = 0; b < NUMBER_OF_BUTTONS; b++) {
+    if (digitalRead(buttonPins[b]) == LOW)
+      bitSet(pins, b);
+  }
+  return pins;
+}
+#endif
+
+/* Run one sample of the pins (a bit per BUTTON_*, set while down) through
+   the debouncer, setting buttonsPressed and buttonsReleased */
+void debounceButtons(uint8_t pins) {
+  uint8_t locked = buttonCountHigh | buttonCountLow;
+  uint8_t changed = (pins ^ buttonsDebounced) & ~locked;
+
+  // count the lockouts down, 3 to 2 to 1 to 0, then start them where an edge was taken
+  buttonCountHigh &= buttonCountLow;
+  buttonCountLow = ~buttonCountLow & locked;
+  buttonCountHigh |= changed;
+  buttonCountLow |= changed;
+
+  buttonsDebounced ^= changed;
+  buttonsPressed = changed & buttonsDebounced;
+  buttonsReleased = changed & ~buttonsDebounced;
+}
 
 // to be called from inside main setup()
 void buttonsSetup() {
-  pinMode(MIDDLE_PIN, INPUT_PULLUP);
-  pinMode(UP_PIN, INPUT_PULLUP);
-  pinMode(DOWN_PIN, INPUT_PULLUP);
-  pinMode(LEFT_PIN, INPUT_PULLUP);
-  pinMode(RIGHT_PIN, INPUT_PULLUP);
+  for (uint8_t b = 0; b < NUMBER_OF_BUTTONS; b++) {
+    pinMode(buttonPins[b], INPUT_PULLUP);
+  }
+  delayMicroseconds(50); // for the pull-ups to charge the lines
+
+  // buttons held while starting up count as down, without a press
+  buttonsDebounced = readButtonPins();
+  lastButtonSample = millis();
 }
 
 void readButtons() {
-  middleButton.read();
-  upButton.read();
-  downButton.read();
-  leftButton.read();
-  rightButton.read();
+  buttonsPressed = 0;
+  buttonsReleased = 0;
+
+  unsigned long now = millis();
+  if (now - lastButtonSample < BUTTON_SAMPLE_TIME)
+    return;
+  lastButtonSample = now;
+
+  debounceButtons(readButtonPins());
 }
 
 #endif
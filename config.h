@@ -6,9 +6,31 @@
 /* Enable Serial debugging */
 // #define ENABLE_DEBUGGING
 
+/* Keep timing statistics for the main loop, display updates, the encoder
+   interrupt and wheel latency, printed on request over Serial (see
+   instrumentation.h) */
+// #define ENABLE_INSTRUMENTATION
+
+/* Record the last TRACE_SIZE input and output events in RAM, for dumping
+   over the serial port (see trace.h and tools/trace.py). Each event takes 6
+   bytes of RAM. */
+// #define ENABLE_TRACE
+#define TRACE_SIZE 48
+
 /* If debugging is enabled, this is the baud rate */
 #define DEBUG_BAUD 57600
 
+/* How often the buttons are sampled for debouncing (see buttons.h); a press
+   or release is seen at the first sample after it starts, and the three
+   samples after that are ignored while the contacts bounce. Milliseconds */
+#define BUTTON_SAMPLE_TIME 5
+
+/* Gestures (see gestures.h): how long a button must be held for a hold, and
+   how soon after a tap the next one must start to make a double tap.
+   Milliseconds */
+#define GESTURE_HOLD_TIME 500
+#define GESTURE_DOUBLE_TAP_TIME 250
+
 /* Define how long the virtual keys should be pressed for either a "regular"
    keypress or a "long" keypress. Milliseconds. */
 #define KEY_DOWN_TIME_REGULAR 10
@@ -25,23 +47,99 @@
 /* Text displayed on screen when in screensaver mode */
 #define SCREENSAVER_TEXT "scrnsvr"
 
+/* Display contrast, 0-255, normally and while the screensaver runs */
+#define DISPLAY_CONTRAST 0xCF
+#define SCREENSAVER_CONTRAST 0x01
+
+/* How long after the screensaver starts the display is switched off
+   altogether; 0 to leave it on. Milliseconds */
+#define DISPLAY_SLEEPS_IN 600000
+
+/* Sleep the MCU between events instead of polling continuously (see power.h).
+   Buttons without a wake interrupt are seen within about a millisecond. */
+#define ENABLE_IDLE_SLEEP
+
 /* If ENABLE_DEBUGGING is on, this is how often the current state is reported
    on the Serial port. If screensaver mode is enabled, this is also how often
    the screensaver text is moved. Milliseconds */
 #define OUTPUT_EVERY 5000
 
+/* Display updates are drawn a piece at a time between input handling. This is
+   how long each pass through the main loop may spend drawing. Microseconds */
+#define DISPLAY_TIME_BUDGET 1000
+
+/* Run the display's I2C bus at 400kHz instead of the default 100kHz. Most
+   SSD1306 modules support this. */
+// #define DISPLAY_I2C_FAST_MODE
+
+/* Copy the built-in mode labels to the display from bitmaps made by
+   tools/prerender_labels.py, instead of drawing them glyph by glyph. Costs
+   about 2KB of flash for the default font; other text is drawn as before. */
+#define ENABLE_PRERENDERED_LABELS
+
+/* Time between the steps of a macro (see macros.h). The host polls the
+   controller at most once a millisecond, so a shorter gap gains nothing.
+   Microseconds */
+#define MACRO_STEP_GAP 1000
+
+/* Add a second mouse with a high-resolution wheel to the USB device, for the
+   MOUSE_HIRES_SCROLL_* actions (see hires_mouse.h). Without it, or on hosts
+   that don't switch that mouse to fractions of a line, those actions scroll
+   whole lines, keeping the fractions for the next scroll. */
+// #define ENABLE_HIRES_SCROLL
+
+/* Number of high-resolution scroll units to a line, 2 to 127 */
+#define HIRES_SCROLL_MULTIPLIER 8
+
 /* max number of key/mouse actions that can be attached to a single action */
 #define MAX_KEYS_PER_ACTION 3
 
 /* Maximum length of any text label field */
 #define MAX_LABEL_LENGTH 11
 
-/* Wheel acceleration: trigger acceleration when CLICK_ACCEL_TRIGGER or more
-   wheel clicks happen in CLICK_ACCEL_EVERY milliseconds (if the current
-   control mode has a wheel acceleration mode configured). */
-#define CLICK_ACCEL_EVERY 250 // milliseconds
-// trigger accel when wheel clicked more than this in CLICK_ACCEL_EVERY time
-#define CLICK_ACCEL_TRIGGER 5 
+/* Accept control modes uploaded over the serial port and store them in
+   EEPROM (see mode_storage.h and tools/encode_modes.py). Modes already in
+   EEPROM are used either way. */
+// #define ENABLE_MODE_UPLOAD
+
+/* Let software on the host select the control mode and show short labels,
+   through commands over the serial port (see host_control.h and
+   tools/host_context.py) */
+#define ENABLE_HOST_CONTROL
+
+/* How long a label sent by the host stays on screen. Milliseconds */
+#define TRANSIENT_LABEL_TIME 3000
+
+/* EEPROM address the uploaded control modes are stored from. Everything from
+   here to the end of the EEPROM is used: a slot byte and two image slots. */
+#define MODE_IMAGE_ADDRESS 0
+
+/* Number of control modes read from EEPROM whose field positions are kept in
+   RAM. 3 covers the current, previous and quick-toggle modes. */
+#define MODE_CACHE_SIZE 3
+
+/* Encoders with a detent at every other quadrature state (most, including the
+   common EC11) need half-step decoding; comment this out for encoders with a
+   detent every four states (see encoder.h) */
+#define ENCODER_HALF_STEP
+
+/* Number of wheel detents that can be queued between the encoder interrupt
+   and the main loop. Must be a power of two, no larger than 128. */
+#define ENCODER_QUEUE_SIZE 32
+
+/* Wheel acceleration: the wheel speed is estimated from the time between
+   detents. At WHEEL_ACCEL_VELOCITY detents per second or more the current
+   control mode switches to its accelerated wheel actions (if it has any), and
+   switches back once the speed drops below half of that. */
+#define WHEEL_ACCEL_VELOCITY 20 // detents per second
+
+/* Weight given to the newest inter-detent interval by the wheel speed
+   estimate, as a power of two: 1 means 1/2, 2 means 1/4, etc. Lower reacts
+   faster, higher is smoother. */
+#define WHEEL_VELOCITY_SMOOTHING 1
+
+/* Number of points in each wheel acceleration curve (see control_modes.h) */
+#define ACCEL_CURVE_POINTS 4
 
 
 #endif
@@ -3,19 +3,12 @@
 
 /* The struct objects used in control-mode definitions */
 
+#include "mode_labels.h"
+
 #define KEYBOARD_HID_TYPE 0
 #define CONSUMER_HID_TYPE 1
 #define MOUSE_HID_TYPE 2
-struct actionKeypress {
-  const uint8_t hidType; // KEYBOARD_HID_TYPE,  CONSUMER_HID_TYPE, MOUSE_HID_TYPE
-  const uint16_t keyCode; // ConsumerKeycode is uint16t, KeyboardKeycode is uint8_t
-};
-
-struct controlAction {
-  const char name[MAX_LABEL_LENGTH]; // name of action
-  actionKeypress keys[MAX_KEYS_PER_ACTION]; // standard keys to send
-  uint8_t modeMask;
-};
+#define MACRO_HID_TYPE 3 // key code is an index into macroList
 
 /*
 modeMask - binary bitmask
@@ -29,15 +22,118 @@ combine modeMasks using |
 #define LONG_KEY_DOWN_TIME 0b00000001
 
 #define MOUSE_EVENT 0b10000000
-#define MOUSE_SCROLL_POSITIVE MOUSE_EVENT | 0b01000000
-#define MOUSE_SCROLL_NEGATIVE MOUSE_EVENT | 0b00100000
-#define MOUSE_LEFT_CLICK MOUSE_EVENT | 0b00010000
-#define MOUSE_RIGHT_CLICK MOUSE_EVENT | 0b00001000
-#define MOUSE_MIDDLE_CLICK MOUSE_EVENT | 0b00000100
+#define MOUSE_SCROLL_POSITIVE (MOUSE_EVENT | 0b01000000)
+#define MOUSE_SCROLL_NEGATIVE (MOUSE_EVENT | 0b00100000)
+#define MOUSE_LEFT_CLICK (MOUSE_EVENT | 0b00010000)
+#define MOUSE_RIGHT_CLICK (MOUSE_EVENT | 0b00001000)
+#define MOUSE_MIDDLE_CLICK (MOUSE_EVENT | 0b00000100)
+#define MOUSE_ACTION_BITS 0b01111100
+#define MOUSE_HIRES 0b00000010 // only with MOUSE_SCROLL_*: scroll in fractions of a line
+#define MOUSE_HIRES_SCROLL_POSITIVE (MOUSE_SCROLL_POSITIVE | MOUSE_HIRES)
+#define MOUSE_HIRES_SCROLL_NEGATIVE (MOUSE_SCROLL_NEGATIVE | MOUSE_HIRES)
+
+/* A key packed into 16 bits: the HID type in the top two bits and the key
+   code (ConsumerKeycode, KeyboardKeycode or MOUSE_* action) in the rest. All
+   zeros means "no key". The constructor is explicit so that the old
+   {KEY_TYPE, KEY_CODE} pair syntax fails to compile instead of silently
+   filling two key slots; use KEYBOARD_KEY(), CONSUMER_KEY(), MOUSE_ACTION()
+   and MACRO_KEY() instead. */
+#define HID_TYPE_SHIFT 14
+#define KEY_CODE_MASK 0x3FFF
+
+struct actionKeypress {
+  uint16_t packed;
+
+  constexpr actionKeypress() : packed(0) {}
+  explicit constexpr actionKeypress(uint16_t packedKey) : packed(packedKey) {}
+
+  constexpr uint8_t hidType() const { return packed >> HID_TYPE_SHIFT; }
+  constexpr uint16_t keyCode() const { return packed & KEY_CODE_MASK; }
+};
+
+// exactly one MOUSE_* action, and nothing else
+constexpr bool validMouseAction(uint16_t code) {
+  return ((code & ~(MOUSE_EVENT | MOUSE_ACTION_BITS | MOUSE_HIRES)) == 0)
+    && (code & MOUSE_EVENT)
+    && ((code & MOUSE_ACTION_BITS) != 0)
+    && (((code & MOUSE_ACTION_BITS) & ((code & MOUSE_ACTION_BITS) - 1)) == 0)
+    && (!(code & MOUSE_HIRES) || (code & (MOUSE_SCROLL_POSITIVE | MOUSE_SCROLL_NEGATIVE) & MOUSE_ACTION_BITS));
+}
+
+// Compile-time checked construction of an actionKeypress
+template <uint8_t hidType, uint16_t code>
+struct checkedKeypress {
+  static_assert(hidType <= MACRO_HID_TYPE, "unknown HID type");
+  static_assert((code != 0) || (hidType == MACRO_HID_TYPE), "key code 0 means no key");
+  static_assert(code <= KEY_CODE_MASK, "key code does not fit in 14 bits");
+  static_assert((hidType != KEYBOARD_HID_TYPE) || (code <= 0xFF), "keyboard key codes are 8 bits");
+  static_assert((hidType != MOUSE_HID_TYPE) || validMouseAction(code), "mouse action must be exactly one MOUSE_* action");
+
+  static constexpr uint16_t packed = ((uint16_t)hidType << HID_TYPE_SHIFT) | code;
+};
+
+#define KEYBOARD_KEY(code) actionKeypress(checkedKeypress<KEYBOARD_HID_TYPE, (code)>::packed)
+#define CONSUMER_KEY(code) actionKeypress(checkedKeypress<CONSUMER_HID_TYPE, (code)>::packed)
+#define MOUSE_ACTION(code) actionKeypress(checkedKeypress<MOUSE_HID_TYPE, (code)>::packed)
+#define MACRO_KEY(index) actionKeypress(checkedKeypress<MACRO_HID_TYPE, (index)>::packed)
+
+/* A label of the built-in modes: its offset in modeLabels (mode_labels.h,
+   generated by tools/mode_labels.py), which holds every distinct label once.
+   It is written as a string literal and looked up while compiling; a label
+   longer than MAX_LABEL_LENGTH - 1 characters, or missing from the table
+   because the tool wasn't run again, doesn't compile. */
+constexpr bool modeLabelAt(uint16_t at, const char *text) {
+  return (modeLabels[at] == *text) && ((*text == '\0') || modeLabelAt(at + 1, text + 1));
+}
+
+constexpr uint16_t nextModeLabel(uint16_t at) {
+  return (modeLabels[at] == '\0') ? at + 1 : nextModeLabel(at + 1);
+}
+
+constexpr uint16_t findModeLabel(const char *text, uint16_t at = 0) {
+  return (at >= sizeof (modeLabels)) ? throw "label not in mode_labels.h; run tools/mode_labels.py"
+    : modeLabelAt(at, text) ? at : findModeLabel(text, nextModeLabel(at));
+}
+
+struct modeLabel {
+  uint16_t offset;
+
+  constexpr modeLabel() : offset(0) {}
+
+  template <size_t length>
+  constexpr modeLabel(const char (&text)[length]) : offset(findModeLabel(text)) {
+    static_assert(length <= MAX_LABEL_LENGTH, "label longer than MAX_LABEL_LENGTH - 1 characters");
+  }
+};
+
+/* The keys of an action; unused ones are left as no key. Written as one key,
+   or as up to MAX_KEYS_PER_ACTION keys in braces. */
+struct actionKeys {
+  actionKeypress key[MAX_KEYS_PER_ACTION];
+
+  actionKeypress &operator[](uint8_t i) { return key[i]; }
+  constexpr const actionKeypress &operator[](uint8_t i) const { return key[i]; }
+};
+
+struct controlAction {
+  modeLabel name; // name of action; not loaded into RAM, see loadActionName()
+  actionKeys keys; // standard keys to send
+  uint8_t modeMask;
+
+  constexpr controlAction() : name(), keys(), modeMask(0) {}
+
+  template <size_t length>
+  constexpr controlAction(const char (&label)[length], actionKeypress key = actionKeypress(), uint8_t mask = 0)
+    : name(label), keys{{key}}, modeMask(mask) {}
+
+  template <size_t length>
+  constexpr controlAction(const char (&label)[length], actionKeys keyList, uint8_t mask = 0)
+    : name(label), keys(keyList), modeMask(mask) {}
+};
 
 struct controlMode {
-  const char name[MAX_LABEL_LENGTH];
-  const char wheelName[MAX_LABEL_LENGTH]; // name of scroll wheel action
+  modeLabel name;
+  modeLabel wheelName; // name of scroll wheel action
   controlAction left;
   controlAction right;
   controlAction middle;
@@ -45,6 +141,94 @@ struct controlMode {
   controlAction wheelCCW;
   controlAction wheelCWAccel;
   controlAction wheelCCWAccel;
+  uint8_t accelCurve; // index into accelCurves, 0 for none
+};
+
+/* One step of a macro (see macros.h). Steps are written with the STEP_*
+   macros below and a macro ends with STEP_END. */
+struct macroStep {
+  uint8_t op; // MACRO_*
+  uint16_t value; // packed actionKeypress, or milliseconds for MACRO_WAIT
+};
+
+#define MACRO_END 0
+#define MACRO_PRESS 1 // press a key and leave it down
+#define MACRO_RELEASE 2 // release one key
+#define MACRO_TAP 3 // press a key, release it one step later
+#define MACRO_WAIT 4 // wait the given milliseconds instead of the usual step gap
+#define MACRO_RELEASE_ALL 5 // release every key
+
+#define STEP_PRESS(key) {MACRO_PRESS, (key).packed}
+#define STEP_RELEASE(key) {MACRO_RELEASE, (key).packed}
+#define STEP_TAP(key) {MACRO_TAP, (key).packed}
+#define STEP_MOUSE(code) {MACRO_TAP, MOUSE_ACTION(code).packed} // click or scroll
+#define STEP_WAIT(milliseconds) {MACRO_WAIT, (milliseconds)}
+#define STEP_RELEASE_ALL {MACRO_RELEASE_ALL, 0}
+#define STEP_END {MACRO_END, 0}
+
+/* One point of a wheel acceleration curve: at `detentsPerSecond` each detent
+   counts `percent`/100 times. */
+struct accelCurvePoint {
+  uint16_t detentsPerSecond;
+  uint16_t percent;
+};
+
+/* Points must be in increasing order of speed; unused points at the end are
+   left as {}. Speeds between points are interpolated, speeds past the last
+   point use the last point. */
+struct accelCurve {
+  accelCurvePoint points[ACCEL_CURVE_POINTS];
+};
+
+/* The buttons, as numbered by the gesture engine (see gestures.h) */
+#define BUTTON_MIDDLE 0
+#define BUTTON_UP 1
+#define BUTTON_DOWN 2
+#define BUTTON_LEFT 3
+#define BUTTON_RIGHT 4
+#define NUMBER_OF_BUTTONS 5
+
+#define GESTURE_DOUBLE_TAP 0 // the button tapped twice in quick succession
+#define GESTURE_HOLD 1 // the button held down for GESTURE_HOLD_TIME
+#define GESTURE_CHORD 2 // the button pressed while heldButton is down
+
+// what a gesture does
+#define COMMAND_SEND_ACTION 0 // send `action`, released with the button
+#define COMMAND_NEXT_MODE 1 // select the next control mode
+#define COMMAND_TOGGLE_MODE 2 // switch to or back from the quick-toggle mode
+#define COMMAND_NEXT_LAYOUT 3 // switch to the next display layout
+
+#define ALL_MODES 0xFF
+
+/* A gesture of a button bound to something other than the button's own
+   action. Gesture bindings are listed in control_modes.h. */
+struct gestureBinding {
+  uint8_t modeIndex; // mode it applies to, or ALL_MODES
+  uint8_t gesture; // GESTURE_*
+  uint8_t button; // BUTTON_*; for a chord, the button pressed last
+  uint8_t heldButton; // BUTTON_* held down first, for GESTURE_CHORD only
+  uint8_t command; // COMMAND_*
+  controlAction action; // for COMMAND_SEND_ACTION
+};
+
+/* Identifies one of the controlActions of a controlMode, so a single action
+   can be read out of the (flash-resident) mode list without copying the rest
+   of the mode */
+enum actionSlot : uint8_t {
+  LEFT_ACTION,
+  RIGHT_ACTION,
+  MIDDLE_ACTION,
+  WHEEL_CW_ACTION,
+  WHEEL_CCW_ACTION,
+  WHEEL_CW_ACCEL_ACTION,
+  WHEEL_CCW_ACCEL_ACTION
+};
+
+/* What a button does by itself, whatever the mode; see buttonRoles in
+   control_modes.h */
+struct buttonRole {
+  uint8_t command; // COMMAND_*
+  actionSlot slot; // the action of the current mode to send, for COMMAND_SEND_ACTION
 };
 
 
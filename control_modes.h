@@ -7,13 +7,14 @@
 Format for controlMode is:
 
 {{"Mode Name"}, {"Scroll Wheel Function Name"},
-    {"Left Arrow Function Name", {{KEY_TYPE, KEY_CODE}, ..., {KEY_TYPE, KEY_CODE}}, modeMask},
-    {"Right Arrow Function Name", {{KEY_TYPE, KEY_CODE}, ..., {KEY_TYPE, KEY_CODE}}, modeMask},
-    {"Centre Button Action Name", {{KEY_TYPE, KEY_CODE}, ..., {KEY_TYPE, KEY_CODE}}, modeMask},
-    {"CCW Scroll Wheel Action Name", {{KEY_TYPE, KEY_CODE}, ..., {KEY_TYPE, KEY_CODE}}, modeMask},
-    {"CW Scroll Wheel Action Name", {{KEY_TYPE, KEY_CODE}, ..., {KEY_TYPE, KEY_CODE}}, modeMask},
-    {"CCW Scroll Wheel Accelerated Action Name", {{KEY_TYPE, KEY_CODE}, ..., {KEY_TYPE, KEY_CODE}}, modeMask},
-    {"CW Scroll Wheel Accelerated Action Name", {{KEY_TYPE, KEY_CODE}, ..., {KEY_TYPE, KEY_CODE}}, modeMask}},
+    {"Left Arrow Function Name", {KEY, ..., KEY}, modeMask},
+    {"Right Arrow Function Name", {KEY, ..., KEY}, modeMask},
+    {"Centre Button Action Name", {KEY, ..., KEY}, modeMask},
+    {"CCW Scroll Wheel Action Name", {KEY, ..., KEY}, modeMask},
+    {"CW Scroll Wheel Action Name", {KEY, ..., KEY}, modeMask},
+    {"CCW Scroll Wheel Accelerated Action Name", {KEY, ..., KEY}, modeMask},
+    {"CW Scroll Wheel Accelerated Action Name", {KEY, ..., KEY}, modeMask},
+    accelCurve},
 
 Mode Name is required. This is what is displayed at the top of the screen.
 
@@ -21,11 +22,18 @@ Mode Name is required. This is what is displayed at the top of the screen.
 string. If the button/function is ignored, a `{}` can be passed instead.
 
 An array of up to MAX_KEYS_PER_ACTION keys (default 3) can be passed in an array
-for each function. The `KEY_TYPE` can be one of:
+for each function. Each `KEY` is one of:
 
-  * KEYBOARD_HID_TYPE - for standard keyboard keys
-  * CONSUMER_HID_TYPE - for "consumer" keys like volume and media control
-  * MOUSE_HID_TYPE    - for mouse clicks/wheel scrolls
+  * KEYBOARD_KEY(code) - for standard keyboard keys, e.g. KEYBOARD_KEY(KEY_SPACE)
+  * CONSUMER_KEY(code) - for "consumer" keys like volume and media control
+  * MOUSE_ACTION(code) - for mouse clicks/wheel scrolls, e.g. MOUSE_ACTION(MOUSE_LEFT_CLICK).
+    MOUSE_HIRES_SCROLL_POSITIVE/NEGATIVE scroll in fractions of a line, which
+    with an acceleration curve gives smooth scrolling (see ENABLE_HIRES_SCROLL
+    in config.h)
+  * MACRO_KEY(index) - to play a macro from `macroList` (below), e.g. MACRO_KEY(0)
+
+These are checked when compiling: an unknown key type, a key code that is too
+large or a mouse action that isn't exactly one MOUSE_* action is an error.
 
 All keycodes will be sent and released simultaneously.
 
@@ -34,97 +42,221 @@ It an be one of:
   * 0b00000000 - default (short) keypress time (10ms)
   * 0b00000001 - long keypress time (700ms)
 
-**Note** Due to memory limitations you can only have about 5-7 active control modes
-before you run out of memory and the display becomes erratic.
+accelCurve is optional; it is the index of an entry in `accelCurves` (below)
+that scales the wheel actions by how fast the wheel is turned. Mouse scrolls
+are scaled in lines, other actions are repeated. Defaults to 0 (no scaling).
+To use it, pass `{}` for any unused accelerated wheel actions before it.
+
+The mode list is stored in flash (PROGMEM) and only the label or action in use
+is copied into RAM, so adding modes costs flash space but no RAM. Labels are
+kept once each in mode_labels.h, and each mode only holds their offsets: after
+changing the labels here (including those of the gesture bindings below), run
+tools/mode_labels.py to regenerate it. A label that isn't in it is a compile
+error.
+
+If a mode image has been uploaded to EEPROM (see mode_storage.h and
+tools/encode_modes.py), its modes are used instead of this list, which stays
+as the fallback.
+
+After changing the labels here, run tools/prerender_labels.py to update the
+prerendered bitmaps used with ENABLE_PRERENDERED_LABELS; until then the
+changed labels are simply drawn with the font.
+
+**REMEMBER**: Any text label cannot be longer than MAX_LABEL_LENGTH - 1 (default 10 characters);
+a longer one is a compile error
+*/
+
+/*
+Wheel acceleration curves, each a list of up to ACCEL_CURVE_POINTS
+{detentsPerSecond, percent} points. See `accelCurve` in control_mode_structs.h.
+*/
+const accelCurve accelCurves[] PROGMEM = {
+    // 0: no acceleration
+    {{{0, 100}}},
+
+    // 1: gentle, for seeking and stepping through lists
+    {{{0, 100}, {15, 100}, {40, 200}}},
+
+    // 2: steep, for scrolling long documents
+    {{{0, 100}, {8, 100}, {25, 300}, {60, 800}}},
+};
+
+/*
+Macros: sequences of key presses, releases and pauses, for when pressing up
+to MAX_KEYS_PER_ACTION keys at once isn't enough. Each is a list of steps
+ending with STEP_END:
 
-**REMEMBER**: Any text label cannot be longer than MAX_LABEL_LENGTH (default 12 characters)
+  * STEP_PRESS(KEY) - press a key and keep it down
+  * STEP_RELEASE(KEY) - release a key
+  * STEP_TAP(KEY) - press a key and release it again
+  * STEP_MOUSE(code) - click or scroll, e.g. STEP_MOUSE(MOUSE_LEFT_CLICK)
+  * STEP_WAIT(milliseconds) - pause
+  * STEP_RELEASE_ALL - release every key
+
+where KEY is written as for control modes. Steps are MACRO_STEP_GAP (default
+1ms) apart. Everything still pressed is released at the end.
+
+A macro is played by putting MACRO_KEY(index) in an action, where index is its
+position in `macroList`.
 */
 
-const controlMode controlModeList[] = {
+// 0: save, confirm, then mute
+const macroStep saveAndMute[] PROGMEM = {
+    STEP_PRESS(KEYBOARD_KEY(KEY_LEFT_GUI)),
+    STEP_TAP(KEYBOARD_KEY(KEY_S)),
+    STEP_RELEASE_ALL,
+    STEP_TAP(KEYBOARD_KEY(KEY_ENTER)),
+    STEP_WAIT(50),
+    STEP_TAP(CONSUMER_KEY(MEDIA_VOLUME_MUTE)),
+    STEP_END
+};
+
+const macroStep * const macroList[] PROGMEM = {
+    saveAndMute,
+};
+
+constexpr controlMode controlModeList[] PROGMEM = {
     {{"Volume"}, {"Volume"},
      {},
      {},
-     {"Mute", {CONSUMER_HID_TYPE, MEDIA_VOLUME_MUTE}},
-     {"-", {CONSUMER_HID_TYPE, MEDIA_VOLUME_DOWN}},
-     {"+", {CONSUMER_HID_TYPE, MEDIA_VOLUME_UP}}},
+     {"Mute", CONSUMER_KEY(MEDIA_VOLUME_MUTE)},
+     {"-", CONSUMER_KEY(MEDIA_VOLUME_DOWN)},
+     {"+", CONSUMER_KEY(MEDIA_VOLUME_UP)}},
 
     {{"Media"}, {"Volume"},
-     {"Prev\n<<", {CONSUMER_HID_TYPE, HID_CONSUMER_SCAN_PREVIOUS_TRACK}},
-     {"Next\n>>", {CONSUMER_HID_TYPE, HID_CONSUMER_SCAN_NEXT_TRACK}},
-     {"Play\nPause", {CONSUMER_HID_TYPE, MEDIA_PLAY_PAUSE}},
-     {"-", {CONSUMER_HID_TYPE, MEDIA_VOLUME_DOWN}},
-     {"+", {CONSUMER_HID_TYPE, MEDIA_VOLUME_UP}}},
+     {"Prev\n<<", CONSUMER_KEY(HID_CONSUMER_SCAN_PREVIOUS_TRACK)},
+     {"Next\n>>", CONSUMER_KEY(HID_CONSUMER_SCAN_NEXT_TRACK)},
+     {"Play\nPause", CONSUMER_KEY(MEDIA_PLAY_PAUSE)},
+     {"-", CONSUMER_KEY(MEDIA_VOLUME_DOWN)},
+     {"+", CONSUMER_KEY(MEDIA_VOLUME_UP)}},
 
     // {{"Media"}, {"Seek"},
-    //  {"Prev\nTrack", {CONSUMER_HID_TYPE, HID_CONSUMER_SCAN_PREVIOUS_TRACK}},
-    //  {"Next\nTrack", {CONSUMER_HID_TYPE, HID_CONSUMER_SCAN_NEXT_TRACK}},
-    //  {"Play\nPause", {CONSUMER_HID_TYPE, MEDIA_PLAY_PAUSE}},
-    //  {"<", {CONSUMER_HID_TYPE, HID_CONSUMER_SCAN_PREVIOUS_TRACK}, LONG_KEY_DOWN_TIME},
-    //  {">", {CONSUMER_HID_TYPE, HID_CONSUMER_SCAN_NEXT_TRACK}, LONG_KEY_DOWN_TIME}},
+    //  {"Prev\nTrack", CONSUMER_KEY(HID_CONSUMER_SCAN_PREVIOUS_TRACK)},
+    //  {"Next\nTrack", CONSUMER_KEY(HID_CONSUMER_SCAN_NEXT_TRACK)},
+    //  {"Play\nPause", CONSUMER_KEY(MEDIA_PLAY_PAUSE)},
+    //  {"<", CONSUMER_KEY(HID_CONSUMER_SCAN_PREVIOUS_TRACK), LONG_KEY_DOWN_TIME},
+    //  {">", CONSUMER_KEY(HID_CONSUMER_SCAN_NEXT_TRACK), LONG_KEY_DOWN_TIME}},
 
     {{"VLC"}, {"Scrub"},
       {"Prev\n<<",
-        {{KEYBOARD_HID_TYPE, KEY_LEFT_GUI}, {KEYBOARD_HID_TYPE, KEY_LEFT_ARROW}}
+        {KEYBOARD_KEY(KEY_LEFT_GUI), KEYBOARD_KEY(KEY_LEFT_ARROW)}
       },
       {"Next\n>>",
-        {{KEYBOARD_HID_TYPE, KEY_LEFT_GUI}, {KEYBOARD_HID_TYPE, KEY_RIGHT_ARROW}}
+        {KEYBOARD_KEY(KEY_LEFT_GUI), KEYBOARD_KEY(KEY_RIGHT_ARROW)}
       },
       {"Play\nPause",
-        {KEYBOARD_HID_TYPE, KEY_SPACE}
+        KEYBOARD_KEY(KEY_SPACE)
       },
       {"<",
         {
-          {KEYBOARD_HID_TYPE, KEY_LEFT_CTRL},
-          {KEYBOARD_HID_TYPE, KEY_LEFT_GUI},
-          {KEYBOARD_HID_TYPE, KEY_LEFT_ARROW}
+          KEYBOARD_KEY(KEY_LEFT_CTRL),
+          KEYBOARD_KEY(KEY_LEFT_GUI),
+          KEYBOARD_KEY(KEY_LEFT_ARROW)
         }
       },
       {">",
         {
-          {KEYBOARD_HID_TYPE, KEY_LEFT_CTRL},
-          {KEYBOARD_HID_TYPE, KEY_LEFT_GUI},
-          {KEYBOARD_HID_TYPE, KEY_RIGHT_ARROW}
+          KEYBOARD_KEY(KEY_LEFT_CTRL),
+          KEYBOARD_KEY(KEY_LEFT_GUI),
+          KEYBOARD_KEY(KEY_RIGHT_ARROW)
         }
       },
       {"<<",
         {
-          {KEYBOARD_HID_TYPE, KEY_LEFT_ARROW}
+          KEYBOARD_KEY(KEY_LEFT_ARROW)
         }
       },
       {">>",
         {
-          {KEYBOARD_HID_TYPE, KEY_RIGHT_ARROW}
+          KEYBOARD_KEY(KEY_RIGHT_ARROW)
         }
       }
     },
 
     {{"YouTube"}, {"Scrub"},
-     {"Seek\n<<", {KEYBOARD_HID_TYPE, KEY_J}},
-     {"Seek\n>>", {KEYBOARD_HID_TYPE, KEY_L}},
-     {"Play\nPause", {KEYBOARD_HID_TYPE, KEY_SPACE}},
-     {"<", {KEYBOARD_HID_TYPE, KEY_LEFT_ARROW}},
-     {">", {KEYBOARD_HID_TYPE, KEY_RIGHT_ARROW}}},
+     {"Seek\n<<", KEYBOARD_KEY(KEY_J)},
+     {"Seek\n>>", KEYBOARD_KEY(KEY_L)},
+     {"Play\nPause", KEYBOARD_KEY(KEY_SPACE)},
+     {"<", KEYBOARD_KEY(KEY_LEFT_ARROW)},
+     {">", KEYBOARD_KEY(KEY_RIGHT_ARROW)},
+     {}, {}, 1},
 
     {{"Mouse"}, {"Scroll"},
-     {"Left\nBtn", {MOUSE_HID_TYPE, MOUSE_LEFT_CLICK}},
-     {"Right\nBtn", {MOUSE_HID_TYPE, MOUSE_RIGHT_CLICK}},
-     {"Mid\nBtn", {MOUSE_HID_TYPE, MOUSE_MIDDLE_CLICK}},
-     {"^", {MOUSE_HID_TYPE, MOUSE_SCROLL_NEGATIVE}},
-     {"_", {MOUSE_HID_TYPE, MOUSE_SCROLL_POSITIVE}}},
+     {"Left\nBtn", MOUSE_ACTION(MOUSE_LEFT_CLICK)},
+     {"Right\nBtn", MOUSE_ACTION(MOUSE_RIGHT_CLICK)},
+     {"Mid\nBtn", MOUSE_ACTION(MOUSE_MIDDLE_CLICK)},
+     {"^", MOUSE_ACTION(MOUSE_SCROLL_NEGATIVE)},
+     {"_", MOUSE_ACTION(MOUSE_SCROLL_POSITIVE)},
+     {}, {}, 2},
+
+    // {{"Smooth"}, {"Scroll"},
+    //  {"Left\nBtn", MOUSE_ACTION(MOUSE_LEFT_CLICK)},
+    //  {"Right\nBtn", MOUSE_ACTION(MOUSE_RIGHT_CLICK)},
+    //  {"Mid\nBtn", MOUSE_ACTION(MOUSE_MIDDLE_CLICK)},
+    //  {"^", MOUSE_ACTION(MOUSE_HIRES_SCROLL_NEGATIVE)},
+    //  {"_", MOUSE_ACTION(MOUSE_HIRES_SCROLL_POSITIVE)},
+    //  {}, {}, 2},
 
     // {{"Navigation"}, {"Page"},
-    //  {"Prev\nPage", {{KEYBOARD_HID_TYPE, KEY_LEFT_GUI}, {KEYBOARD_HID_TYPE, KEY_LEFT_BRACE}}},  // CONSUMER_BROWSER_BACK maybe
-    //  {"Next\nPage", {{KEYBOARD_HID_TYPE, KEY_LEFT_GUI}, {KEYBOARD_HID_TYPE, KEY_RIGHT_BRACE}}}, // CONSUMER_BROWSER_FORWARD maybe
-    //  {"Enter", {KEYBOARD_HID_TYPE, KEY_ENTER}},
-    //  {"^", {KEYBOARD_HID_TYPE, KEY_PAGE_UP}},
-    //  {"v", {KEYBOARD_HID_TYPE, KEY_PAGE_DOWN}}},
+    //  {"Prev\nPage", {KEYBOARD_KEY(KEY_LEFT_GUI), KEYBOARD_KEY(KEY_LEFT_BRACE)}},  // CONSUMER_BROWSER_BACK maybe
+    //  {"Next\nPage", {KEYBOARD_KEY(KEY_LEFT_GUI), KEYBOARD_KEY(KEY_RIGHT_BRACE)}}, // CONSUMER_BROWSER_FORWARD maybe
+    //  {"Enter", KEYBOARD_KEY(KEY_ENTER)},
+    //  {"^", KEYBOARD_KEY(KEY_PAGE_UP)},
+    //  {"v", KEYBOARD_KEY(KEY_PAGE_DOWN)}},
 
     {{"System"}, {"Bright"},
-     {"Ext\n-", {KEYBOARD_HID_TYPE, KEY_SCROLL_LOCK}}, // External Display
-     {"Ext\n+", {KEYBOARD_HID_TYPE, KEY_PAUSE}},       // External Display
+     {"Ext\n-", KEYBOARD_KEY(KEY_SCROLL_LOCK)}, // External Display
+     {"Ext\n+", KEYBOARD_KEY(KEY_PAUSE)},       // External Display
      {},
-     {"-", {CONSUMER_HID_TYPE, CONSUMER_BRIGHTNESS_DOWN}}, // Internal Display
-     {"+", {CONSUMER_HID_TYPE, CONSUMER_BRIGHTNESS_UP}}},   // Internal Display
+     {"-", CONSUMER_KEY(CONSUMER_BRIGHTNESS_DOWN)}, // Internal Display
+     {"+", CONSUMER_KEY(CONSUMER_BRIGHTNESS_UP)}},   // Internal Display
+};
+
+/*
+What each button does by itself, in the order of BUTTON_*: send one of the
+current mode's actions for as long as it is held (COMMAND_SEND_ACTION), or run
+one of the other commands described with the gestures below.
+*/
+const buttonRole buttonRoles[NUMBER_OF_BUTTONS] PROGMEM = {
+    {COMMAND_SEND_ACTION, MIDDLE_ACTION}, // BUTTON_MIDDLE
+    {COMMAND_NEXT_MODE}, // BUTTON_UP
+    {COMMAND_TOGGLE_MODE}, // BUTTON_DOWN
+    {COMMAND_SEND_ACTION, LEFT_ACTION}, // BUTTON_LEFT
+    {COMMAND_SEND_ACTION, RIGHT_ACTION}, // BUTTON_RIGHT
+};
+
+/*
+Gestures: besides its own action (sent as soon as it is pressed), a button can
+have a double tap or a hold bound to something else, and buttons can be
+chorded by holding one and pressing another. Each binding is
+
+  {modeIndex, gesture, button, heldButton, command, action}
+
+  * modeIndex - index of the mode it applies to, or ALL_MODES
+  * gesture - GESTURE_DOUBLE_TAP, GESTURE_HOLD or GESTURE_CHORD
+  * button - BUTTON_MIDDLE, BUTTON_UP, BUTTON_DOWN, BUTTON_LEFT or BUTTON_RIGHT
+  * heldButton - for GESTURE_CHORD, the button held down first; else 0
+  * command - COMMAND_SEND_ACTION to send `action` (written as for control
+    modes), or COMMAND_NEXT_MODE, COMMAND_TOGGLE_MODE or COMMAND_NEXT_LAYOUT
+
+A button's own action is only held back when the current mode binds a double
+tap or hold of that button, to tell them apart: a tap is then sent once the
+button is released, or GESTURE_DOUBLE_TAP_TIME later if a double tap is
+bound. Chords cost nothing; the held button has already done its own thing,
+unless it was being held back, in which case it does nothing.
+*/
+constexpr gestureBinding gestureBindings[] PROGMEM = {
+    // hold up and press middle to switch the display layout
+    {ALL_MODES, GESTURE_CHORD, BUTTON_MIDDLE, BUTTON_UP, COMMAND_NEXT_LAYOUT},
+
+    // {1, GESTURE_DOUBLE_TAP, BUTTON_MIDDLE, 0, COMMAND_SEND_ACTION, {"Mute", CONSUMER_KEY(MEDIA_VOLUME_MUTE)}},
+    // {ALL_MODES, GESTURE_HOLD, BUTTON_DOWN, 0, COMMAND_NEXT_LAYOUT},
+    // {ALL_MODES, GESTURE_CHORD, BUTTON_RIGHT, BUTTON_LEFT, COMMAND_SEND_ACTION, {"Save", MACRO_KEY(0)}},
+
+#ifdef EXTRA_GESTURE_BINDINGS
+    // bindings defined before this file is included, e.g. by the host tests
+    EXTRA_GESTURE_BINDINGS
+#endif
 };
 
 /* Index of mode to use upon startup, starting from 0 (zero) */
@@ -133,4 +265,8 @@ const controlMode controlModeList[] = {
 /* How many lines to scroll for mouse wheel events */
 #define MOUSE_SCROLL_AMOUNT 5
 
+/* How far to scroll for high-resolution mouse wheel events, in
+   1/HIRES_SCROLL_MULTIPLIER of a line */
+#define HIRES_SCROLL_AMOUNT 4
+
 #endif
@@ -17,10 +17,38 @@ SSD1306AsciiWire oled;
 uint8_t displayHeightInRows;
 uint8_t displayWidthInColumns;
 
+/* With instrumentation, an estimate of the bytes sent to the display by the
+   field drawing, for the benchmarks: 3 command bytes per cursor move plus
+   every byte of display memory written */
+#ifdef ENABLE_INSTRUMENTATION
+  uint32_t displayBusBytes = 0;
+  #define countDisplayBytes(bytes) displayBusBytes += (bytes)
+#else
+  #define countDisplayBytes(bytes)
+#endif
+
+/* Time to send one byte to the display: 9 bits on the I2C bus */
+#ifdef DISPLAY_I2C_FAST_MODE
+  #define DISPLAY_BYTE_MICROS 23
+#else
+  #define DISPLAY_BYTE_MICROS 90
+#endif
+
+/* Most bytes of display memory one drawing step writes, so that a step
+   together with its 3-byte cursor move fits in DISPLAY_TIME_BUDGET. A full
+   display row is 128 bytes, over 11ms at 100kHz, so clears and prerendered
+   rows are done this many columns at a time. */
+#define DISPLAY_STEP_BYTES (DISPLAY_TIME_BUDGET / DISPLAY_BYTE_MICROS - 3)
+#if DISPLAY_STEP_BYTES < 1
+  #error "DISPLAY_TIME_BUDGET is too short to send anything to the display"
+#endif
+
 // to be called from inside main setup()
 void displaySetup() {
   Wire.begin();
-  // Wire.setClock(400000L);
+  #ifdef DISPLAY_I2C_FAST_MODE
+    Wire.setClock(400000L);
+  #endif
 
   #if RST_PIN >= 0
     oled.begin(&Adafruit128x64, I2C_ADDRESS, RST_PIN);
@@ -28,116 +56,397 @@ void displaySetup() {
     oled.begin(&Adafruit128x64, I2C_ADDRESS);
   #endif // RST_PIN >= 0
 
+  oled.setContrast(DISPLAY_CONTRAST);
   oled.clear();
   oled.print(F("Display\nInitialized"));
 }
 
-void appendCharToArray(char * charArray, char aChar) {
-  /* strcat needs two char arrays, so we build one with the current char
-      https://stackoverflow.com/posts/22429675/revisions */
-  char cToStr[2] { aChar, '\0' };
-  strcat(charArray, cToStr);
+/* Power saving for the screensaver. Neither changes what is in display
+   memory, so nothing has to be redrawn afterwards. */
+bool displayDimmed = false;
+bool displayAsleep = false;
+
+void dimDisplay(bool dim) {
+  oled.setContrast(dim ? SCREENSAVER_CONTRAST : DISPLAY_CONTRAST);
+  displayDimmed = dim;
+}
+
+void sleepDisplay(bool sleep) {
+  oled.ssd1306WriteCmd(sleep ? SSD1306_DISPLAYOFF : SSD1306_DISPLAYON);
+  displayAsleep = sleep;
+}
+
+/* A line of text rendered ahead of time by tools/prerender_labels.py. The
+   bitmap holds the display memory bytes of each 8-pixel row of the line in
+   turn, `width` bytes each. */
+struct prerenderedLabel {
+  const uint8_t *font;
+  const char *text;
+  const uint8_t *bitmap;
+  uint8_t length; // of the text
+  uint8_t width; // pixels
+};
+
+#ifdef ENABLE_PRERENDERED_LABELS
+#include "prerendered_labels.h"
+
+/* The prerendered bitmap of a line of text in the current font, or NULL if
+   there isn't one */
+const prerenderedLabel *findPrerenderedLabel(const char *text, uint8_t length) {
+  const uint8_t *font = oled.font();
+  for (uint8_t i = 0; i < sizeof (prerenderedLabels) / sizeof (prerenderedLabels[0]); i++) {
+    const prerenderedLabel *label = &prerenderedLabels[i];
+    if ((pgm_read_ptr(&label->font) == font) && (pgm_read_byte(&label->length) == length)
+        && (strncmp_P(text, (const char *)pgm_read_ptr(&label->text), length) == 0))
+      return label;
+  }
+  return NULL;
+}
+#else
+  #define findPrerenderedLabel(text, length) NULL
+#endif
+
+#define ALIGN_LEFT 0
+#define ALIGN_CENTER 1
+#define ALIGN_RIGHT 2
+
+/* Longest text a display field can hold, including the terminator */
+#define MAX_FIELD_LENGTH (MAX_LABEL_LENGTH*2)
+
+/* Most lines a display field can show; further lines are dropped */
+#define MAX_FIELD_LINES 3
+
+/* Where one line of a field's text goes on screen */
+struct fieldLine {
+  uint8_t start; // offset of the line in the field text
+  uint8_t length;
+  uint8_t col; // pixels
+  uint8_t row;
+  const prerenderedLabel *prerendered; // in flash; NULL to draw with the font
+};
+
+/* A separately-drawn area of the display. It holds its text together with the
+   precomputed position of every line, so drawing it is just setting the
+   cursor and printing, or copying a prerendered bitmap, and it is only laid
+   out, cleared and redrawn again when its text, row or the font changes. */
+struct displayField {
+  char text[MAX_FIELD_LENGTH];
+  uint8_t row; // row of the first line
+  uint8_t alignment; // ALIGN_LEFT, ALIGN_CENTER or ALIGN_RIGHT
+  uint8_t lineCount; // 0 if nothing is shown
+  fieldLine lines[MAX_FIELD_LINES];
+  // area covered on screen; columns are pixels, rows are 8-pixel display rows; inclusive
+  uint8_t startCol, endCol, startRow, endRow;
+
+  // drawing progress, see serviceDisplay()
+  uint8_t state; // FIELD_IDLE, FIELD_CLEAR_PENDING or FIELD_DRAW_PENDING
+  uint8_t clearRow, clearCol; // next part of the shown area to clear
+  uint8_t drawLine, drawChar; // next character to draw
+  uint8_t drawCol; // next column of a prerendered row, from the start of the line
+  bool shown; // whether anything of the field may be on screen, within:
+  uint8_t shownStartCol, shownEndCol, shownStartRow, shownEndRow;
+};
+
+#define FIELD_IDLE 0
+#define FIELD_CLEAR_PENDING 1 // what is shown must be cleared before drawing
+#define FIELD_DRAW_PENDING 2
+
+/* Display contents are unknown; the next render clears the whole display and
+   draws every field */
+bool displayInvalidated = true;
+
+// a whole-display clear is in progress, a piece of a row at a time
+bool displayClearPending = false;
+uint8_t displayClearRow = 0;
+uint8_t displayClearCol = 0;
+
+// the oled cursor is already where the next character of a field goes
+bool displayCursorContinues = false;
+
+// font the display fields were laid out with
+const uint8_t *fieldsFont = NULL;
+
+/* Call after anything other than the display field functions draws on the
+   display, e.g. after oled.clear() or a font change. Any drawing still
+   queued is dropped. */
+void invalidateDisplay() {
+  displayInvalidated = true;
+  displayClearPending = false;
+  displayCursorContinues = false;
 }
 
-// Print to oled left-justified with newline support
-void oledPrintLeftJustify(char * msg, uint8_t row)
-{
-  debugf("oledPrintLeftJustify: '");
-  debug(msg);
-  debugfln("'");
+/* Set the text and row of a field and work out where each of its lines goes
+   with the current font. Lines with a prerendered bitmap take their width
+   from it; the others are measured glyph by glyph. An empty text or a row
+   below the bottom of the display leaves the field blank. Text beyond
+   MAX_FIELD_LENGTH - 1 characters is cut off. */
+void layoutField(displayField &field, const char *text, uint8_t row) {
+  strlcpy(field.text, text, sizeof (field.text));
+  field.row = row;
+  field.lineCount = 0;
+
+  if (row > displayHeightInRows-1)
+    return;
+
+  uint8_t lineStart = 0;
+  for (uint8_t i = 0; field.lineCount < MAX_FIELD_LINES; i++) {
+    char c = field.text[i];
+    if ((c != '\n') && (c != '\0'))
+      continue;
 
-  char substr[MAX_LABEL_LENGTH*2] = "";
-  for (uint8_t i = 0; i < strlen(msg); i++) {
-    if (msg[i] == '\n') {
-      oled.setCursor(0, row);
-      oled.print(substr);
+    if (i > lineStart) {
+      const prerenderedLabel *prerendered = findPrerenderedLabel(field.text + lineStart, i - lineStart);
+      uint16_t lineWidth = 0;
+      if (prerendered) {
+        lineWidth = pgm_read_byte(&prerendered->width);
+      } else {
+        for (uint8_t j = lineStart; j < i; j++) {
+          lineWidth += oled.charWidth(field.text[j]) + oled.letterSpacing();
+        }
+      }
 
-      debugf(":");
-      debugln(substr);
+      int16_t col = 0; // signed!
+      if (field.alignment == ALIGN_RIGHT) {
+        col = oled.displayWidth() - lineWidth;
+      } else if (field.alignment == ALIGN_CENTER) {
+        col = (oled.displayWidth() - lineWidth) / 2;
+      }
+      if (col < 0)
+        col = 0;
 
-      strcpy(substr, ""); // empty the temporary string
+      uint8_t endCol = (col + lineWidth > oled.displayWidth()) ? oled.displayWidth() - 1 : col + lineWidth - 1;
+      uint8_t endRow = row + oled.fontRows() - 1;
 
-      row += oled.fontRows();
-    } else {
-      appendCharToArray(substr, msg[i]);
+      if (field.lineCount == 0) {
+        field.startCol = col;
+        field.endCol = endCol;
+        field.startRow = row;
+      } else {
+        if (col < field.startCol) field.startCol = col;
+        if (endCol > field.endCol) field.endCol = endCol;
+      }
+      field.endRow = endRow;
+
+      fieldLine &line = field.lines[field.lineCount++];
+      line.start = lineStart;
+      line.length = i - lineStart;
+      line.col = col;
+      line.row = row;
+      line.prerendered = prerendered;
     }
+
+    if (c == '\0')
+      break;
+
+    row += oled.fontRows();
+    lineStart = i + 1;
   }
-  if (strlen(substr) > 0) {
-    oled.setCursor(0, row);
-    oled.print(substr);
+}
+
+void restartFieldDraw(displayField &field) {
+  field.drawLine = 0;
+  field.drawChar = 0;
+  field.drawCol = 0;
+  field.state = (field.lineCount > 0) ? FIELD_DRAW_PENDING : FIELD_IDLE;
+}
+
+bool areasOverlap(uint8_t aStartCol, uint8_t aEndCol, uint8_t aStartRow, uint8_t aEndRow, displayField &b) {
+  return (aStartCol <= b.shownEndCol) && (b.shownStartCol <= aEndCol)
+    && (aStartRow <= b.shownEndRow) && (b.shownStartRow <= aEndRow);
+}
 
-    debugf(":");
-    debugln(substr);
+// Queue a clear of the whole display followed by a redraw of every field
+void scheduleFullRedraw(displayField *fields, uint8_t numberOfFields) {
+  debugfln("Display: full redraw");
+  displayInvalidated = false;
+  displayClearPending = true;
+  displayClearRow = 0;
+  displayClearCol = 0;
+  for (uint8_t i = 0; i < numberOfFields; i++) {
+    fields[i].shown = false;
+    restartFieldDraw(fields[i]);
   }
 }
 
-// Print to oled right-justified with newline support
-void oledPrintRightJustify(char * msg, uint8_t row) {
-  debugf("oledPrintRightJustify: '");
-  debug(msg);
-  debugfln("'");
+/* If the display was invalidated, queue a full redraw of every field from its
+   cached layout */
+void redrawDisplayFields(displayField *fields, uint8_t numberOfFields) {
+  if (displayInvalidated)
+    scheduleFullRedraw(fields, numberOfFields);
+}
 
-  char substr[MAX_LABEL_LENGTH*2] = "";
-  for (uint8_t i = 0; i < strlen(msg); i++) {
-    if (msg[i] == '\n') {
-      int8_t col = ((oled.displayWidth() - oled.strWidth(substr))); // signed!
+/* Queue the drawing needed to bring the display up to date with the wanted
+   text and row of each field. Only fields whose text or row changed are laid
+   out again, cleared and redrawn, plus any field whose area overlapped a
+   cleared one; a change of font lays out every field again. Queued work for
+   an older version of a field is dropped, so a frame that is out of date
+   before it is finished is never completed. */
+void renderDisplayFields(displayField *fields, uint8_t numberOfFields, char texts[][MAX_FIELD_LENGTH], const uint8_t *rows) {
+  bool fontChanged = (fieldsFont != oled.font());
+  fieldsFont = oled.font();
 
-      oled.setCursor(col < 0 ? 0 : col, row);
-      oled.print(substr);
+  if (displayInvalidated) {
+    for (uint8_t i = 0; i < numberOfFields; i++) {
+      layoutField(fields[i], texts[i], rows[i]);
+    }
+    scheduleFullRedraw(fields, numberOfFields);
+    return;
+  }
 
-      debug(substr);
-      debugfln(":");
+  for (uint8_t i = 0; i < numberOfFields; i++) {
+    displayField &field = fields[i];
+    if (!fontChanged && (field.row == rows[i]) && (strcmp(field.text, texts[i]) == 0))
+      continue;
 
-      strcpy(substr, ""); // empty the temporary string
+    layoutField(field, texts[i], rows[i]);
 
-      row += oled.fontRows();
-    } else {
-      appendCharToArray(substr, msg[i]);
+    if (!field.shown) {
+      restartFieldDraw(field);
+      continue;
+    }
+
+    if (field.state != FIELD_CLEAR_PENDING) {
+      field.state = FIELD_CLEAR_PENDING;
+      field.clearRow = field.shownStartRow;
+      field.clearCol = field.shownStartCol;
+
+      // clearing also wipes whatever overlaps, so that has to be drawn again
+      for (uint8_t j = 0; j < numberOfFields; j++) {
+        if ((j != i) && fields[j].shown && (fields[j].state != FIELD_CLEAR_PENDING)
+            && areasOverlap(field.shownStartCol, field.shownEndCol, field.shownStartRow, field.shownEndRow, fields[j])) {
+          restartFieldDraw(fields[j]);
+        }
+      }
     }
   }
-  if (strlen(substr) > 0) {
-    int8_t col = ((oled.displayWidth() - oled.strWidth(substr))); // signed!
-    oled.setCursor(col < 0 ? 0 : col, row);
-    oled.print(substr);
+}
 
-    debug(substr);
-    debugfln(":");
+// Is there queued drawing left?
+bool displayBusy(displayField *fields, uint8_t numberOfFields) {
+  if (displayClearPending)
+    return true;
+  for (uint8_t i = 0; i < numberOfFields; i++) {
+    if (fields[i].state != FIELD_IDLE)
+      return true;
   }
+  return false;
 }
 
-// Print to oled centered with newline support
-void oledPrintCentered(char * msg, uint8_t row) {
-  debugf("oledPrintCentered: '");
-  debug(msg);
-  debugfln("'");
+/* Clear a row from col up to endCol, but no more than DISPLAY_STEP_BYTES
+   columns of it. Returns the column to go on from, or 0 once endCol is
+   cleared. */
+uint8_t clearRowPiece(uint8_t row, uint8_t col, uint8_t endCol) {
+  uint8_t last = (endCol - col >= DISPLAY_STEP_BYTES) ? col + DISPLAY_STEP_BYTES - 1 : endCol;
+  oled.clear(col, last, row, row);
+  countDisplayBytes(3 + last - col + 1);
+  displayCursorContinues = false;
+  return (last == endCol) ? 0 : last + 1;
+}
+
+/* Move on to the next line of a field being drawn, or finish it */
+void nextFieldLine(displayField &field) {
+  field.drawChar = 0;
+  field.drawCol = 0;
+  displayCursorContinues = false;
+  if (++field.drawLine >= field.lineCount)
+    field.state = FIELD_IDLE;
+}
 
-  char substr[MAX_LABEL_LENGTH*2] = "";
-  for (uint8_t i = 0; i < strlen(msg); i++) {
-    if (msg[i] == '\n') {
-      int8_t col = ((oled.displayWidth() - oled.strWidth(substr)) / 2); // signed!
+/* Do one small piece of the queued drawing: up to DISPLAY_STEP_BYTES columns
+   of a row of a clear or of a prerendered line, or one character of a field.
+   Whole-display clears go first, then field clears, then field draws.
+   Returns false if there was nothing left to do. */
+bool displayStep(displayField *fields, uint8_t numberOfFields) {
+  if (displayClearPending) {
+    displayClearCol = clearRowPiece(displayClearRow, displayClearCol, oled.displayWidth() - 1);
+    if ((displayClearCol == 0) && (++displayClearRow >= oled.displayRows()))
+      displayClearPending = false;
+    return true;
+  }
 
-      oled.setCursor(col < 0 ? 0 : col, row);
-      oled.print(substr);
+  for (uint8_t i = 0; i < numberOfFields; i++) {
+    displayField &field = fields[i];
+    if (field.state != FIELD_CLEAR_PENDING)
+      continue;
 
-      debugf(":");
-      debug(substr);
-      debugfln(":");
+    field.clearCol = clearRowPiece(field.clearRow, field.clearCol, field.shownEndCol);
+    if (field.clearCol != 0)
+      return true;
+    field.clearCol = field.shownStartCol;
+    if (++field.clearRow > field.shownEndRow) {
+      field.shown = false;
+      restartFieldDraw(field);
+    }
+    return true;
+  }
 
-      strcpy(substr, ""); // empty the temporary string
+  for (uint8_t i = 0; i < numberOfFields; i++) {
+    displayField &field = fields[i];
+    if (field.state != FIELD_DRAW_PENDING)
+      continue;
 
-      row += oled.fontRows();
-    } else {
-      appendCharToArray(substr, msg[i]);
+    if ((field.drawLine == 0) && (field.drawChar == 0)) {
+      field.shown = true;
+      field.shownStartCol = field.startCol;
+      field.shownEndCol = field.endCol;
+      field.shownStartRow = field.startRow;
+      field.shownEndRow = field.endRow;
     }
+
+    fieldLine &line = field.lines[field.drawLine];
+    if (line.prerendered) {
+      // drawChar counts the rows of the bitmap copied so far, drawCol the
+      // columns of the current one
+      uint8_t width = pgm_read_byte(&line.prerendered->width);
+      uint8_t pieceWidth = (width - field.drawCol > DISPLAY_STEP_BYTES) ? DISPLAY_STEP_BYTES : width - field.drawCol;
+      const uint8_t *bitmap = (const uint8_t *)pgm_read_ptr(&line.prerendered->bitmap) + field.drawChar * width + field.drawCol;
+      oled.setCursor(line.col + field.drawCol, line.row + field.drawChar);
+      for (uint8_t b = 0; b < pieceWidth; b++) {
+        oled.ssd1306WriteRam(pgm_read_byte(bitmap + b));
+      }
+      countDisplayBytes(3 + pieceWidth);
+      displayCursorContinues = false;
+
+      field.drawCol += pieceWidth;
+      if (field.drawCol < width)
+        return true;
+      field.drawCol = 0;
+      if (++field.drawChar >= oled.fontRows())
+        nextFieldLine(field);
+      return true;
+    }
+
+    if ((field.drawChar == 0) || !displayCursorContinues) {
+      // find where this character goes from the widths of the ones before it
+      uint8_t col = line.col;
+      for (uint8_t c = 0; c < field.drawChar; c++) {
+        col += oled.charWidth(field.text[line.start + c]) + oled.letterSpacing();
+      }
+      oled.setCursor(col, line.row);
+      countDisplayBytes(3);
+    }
+    char c = field.text[line.start + field.drawChar];
+    oled.write(c);
+    // every row of the character after the first starts with a cursor move
+    countDisplayBytes((oled.charWidth(c) + oled.letterSpacing()) * oled.fontRows() + 3 * (oled.fontRows() - 1));
+    displayCursorContinues = true;
+
+    if (++field.drawChar >= line.length)
+      nextFieldLine(field);
+    return true;
   }
-  if (strlen(substr) > 0) {
-    int8_t col = ((oled.displayWidth() - oled.strWidth(substr)) / 2); // signed!
-    oled.setCursor(col < 0 ? 0 : col, row);
-    oled.print(substr);
-
-    debugf(":");
-    debug(substr);
-    debugfln(":");
+
+  return false;
+}
+
+/* Drain queued drawing for up to DISPLAY_TIME_BUDGET microseconds; to be
+   called once per loop. At least one step is done per call so drawing
+   always makes progress. */
+void serviceDisplay(displayField *fields, uint8_t numberOfFields) {
+  unsigned long start = micros();
+  while (displayStep(fields, numberOfFields)) {
+    if (micros() - start >= DISPLAY_TIME_BUDGET)
+      break;
   }
 }
 
@@ -1,38 +1,274 @@
 #ifndef ENCODER_H
 #define ENCODER_H
 
-// Be sure to enable half-step mode
-#include <Rotary.h>  // https://github.com/brianlow/Rotary
+#include "instrumentation.h"
 
-Rotary encoder = Rotary(ENC_PIN_A, ENC_PIN_B);
+/*
+Quadrature decoding. The encoder's A and B pins are read together straight
+from PINB in the pin-change interrupt, as a state (B << 1) | A, and each
+change of state is looked up in encoderTransitions: a quarter step one way or
+the other, or an invalid transition where both pins changed at once (a
+missed state). The quarter steps are summed, and a detent is queued when the
+wheel reaches a detent position having moved a whole detent: two quarter
+steps with ENCODER_HALF_STEP, where 00 and 11 are both detent positions, or
+four without, where only 11 is.
+
+Reaching a detent position having moved less, or back where it started, is a
+bounced transition. Invalid and bounced transitions are
+counted, for spotting a worn encoder or a wheel turned faster than the
+interrupt can follow; ENCODER_ISR_STAT has the worst case time it takes.
+
+decodeEncoder() only works on the states it is given, so it can be fed made-up
+ones.
+*/
+
+#ifndef HOST_SIMULATION
+static_assert((ENC_PIN_A == 8) && (ENC_PIN_B == 9), "the encoder is read from PB4 and PB5");
+#endif
+
+#define ENCODER_REST_STATE 0b11
+#ifdef ENCODER_HALF_STEP
+  #define ENCODER_STEPS_PER_DETENT 2
+#else
+  #define ENCODER_STEPS_PER_DETENT 4
+#endif
+
+#define ENCODER_INVALID 2
+
+/* Indexed by (previous state << 2) | state; turning CW goes through the
+   states 11, 01, 00, 10 */
+const int8_t encoderTransitions[16] PROGMEM = {
+  0, -1, 1, ENCODER_INVALID, // from 00
+  1, 0, ENCODER_INVALID, -1, // from 01
+  -1, ENCODER_INVALID, 0, 1, // from 10
+  ENCODER_INVALID, 1, -1, 0  // from 11
+};
+
+volatile uint8_t encoderState = ENCODER_REST_STATE;
+volatile int8_t encoderSteps = 0; // quarter steps since the last detent position
+
+volatile uint16_t encoderInvalidTransitions = 0;
+volatile uint16_t encoderBouncedTransitions = 0;
+
+// the encoder pins as an encoder state; PB4 is A and PB5 is B
+#ifndef HOST_SIMULATION
+  #define readEncoderPins() ((PINB >> 4) & 0b11)
+#else
+  #define readEncoderPins() ((digitalRead(ENC_PIN_B) << 1) | digitalRead(ENC_PIN_A))
+#endif
 
 // to be called from inside main setup()
 void encoderSetup() {
   pinMode(ENC_PIN_A, INPUT_PULLUP);
   pinMode(ENC_PIN_B, INPUT_PULLUP);
+  delayMicroseconds(50); // for the pull-ups to charge the lines
+  encoderState = readEncoderPins();
+
+  #ifndef HOST_SIMULATION
+    PCICR |= (1 << PCIE0);
+    PCMSK0 |= (1 << PCINT4) | (1 << PCINT5);
+    sei();
+  #endif
+}
+
+/* Detents decoded by the ISR are passed to loop() through a single-producer,
+   single-consumer ring buffer: only the ISR writes encoderQueueHead and only
+   loop() writes encoderQueueTail, so neither side needs to disable
+   interrupts. The indexes run freely and are masked on access. */
+struct encoderEvent {
+  unsigned long time; // micros() when the detent was decoded
+  int8_t direction; // 1 for CW, -1 for CCW
+};
 
-  // https: //github.com/brianlow/Rotary/blob/master/examples/InterruptProMicro/InterruptProMicro.ino
-  encoder.begin();
-  PCICR |= (1 << PCIE0);
-  PCMSK0 |= (1 << PCINT4) | (1 << PCINT5);
-  sei();
+volatile encoderEvent encoderQueue[ENCODER_QUEUE_SIZE];
+volatile uint8_t encoderQueueHead = 0; // next slot the ISR writes
+volatile uint8_t encoderQueueTail = 0; // next slot loop() reads
+
+// detents dropped because the queue was full
+volatile uint16_t encoderQueueOverflows = 0;
+
+#define ENCODER_QUEUE_MASK (ENCODER_QUEUE_SIZE - 1)
+
+// only to be called from the ISR
+void pushEncoderEvent(int8_t direction) {
+  uint8_t head = encoderQueueHead;
+  if ((uint8_t)(head - encoderQueueTail) >= ENCODER_QUEUE_SIZE) {
+    encoderQueueOverflows++;
+    return;
+  }
+
+  encoderQueue[head & ENCODER_QUEUE_MASK].time = micros();
+  encoderQueue[head & ENCODER_QUEUE_MASK].direction = direction;
+  encoderQueueHead = head + 1; // publish only once the event is written
 }
 
-// https: //github.com/brianlow/Rotary/blob/master/examples/InterruptProMicro/InterruptProMicro.ino
-volatile int8_t encoderTurned = 0; // -127 to +127
+/* Follow the encoder to a new state, queueing a detent if it completes one;
+   only to be called from the ISR */
+void decodeEncoder(uint8_t state) {
+  int8_t step = pgm_read_byte(&encoderTransitions[(encoderState << 2) | state]);
+  encoderState = state;
+
+  if (step == 0)
+    return; // another pin on the port changed
+  if (step == ENCODER_INVALID) {
+    if (encoderInvalidTransitions < 0xFFFF)
+      encoderInvalidTransitions++;
+    return;
+  }
+
+  int8_t steps = encoderSteps + step;
+  #ifdef ENCODER_HALF_STEP
+    bool detentPosition = (state == ENCODER_REST_STATE) || (state == 0);
+  #else
+    bool detentPosition = (state == ENCODER_REST_STATE);
+  #endif
+  if (!detentPosition) {
+    encoderSteps = steps;
+    return;
+  }
+
+  encoderSteps = 0;
+  if (steps == ENCODER_STEPS_PER_DETENT) {
+    pushEncoderEvent(1);
+  } else if (steps == -ENCODER_STEPS_PER_DETENT) {
+    pushEncoderEvent(-1);
+  } else if (encoderBouncedTransitions < 0xFFFF) {
+    encoderBouncedTransitions++;
+  }
+}
+
+#ifndef HOST_SIMULATION
 ISR(PCINT0_vect) {
-  unsigned char result = encoder.process();
-  if (result == DIR_NONE) {
-    // do nothing
+  instrumentCyclesStart(isrStart);
+  decodeEncoder(readEncoderPins());
+  instrumentCyclesEnd(ENCODER_ISR_STAT, isrStart);
+}
+#endif
+
+// Look at the oldest queued detent without removing it
+bool peekEncoderEvent(encoderEvent &event) {
+  uint8_t tail = encoderQueueTail;
+  if (tail == encoderQueueHead)
+    return false;
+
+  event.time = encoderQueue[tail & ENCODER_QUEUE_MASK].time;
+  event.direction = encoderQueue[tail & ENCODER_QUEUE_MASK].direction;
+  return true;
+}
+
+// Remove and return the oldest queued detent
+bool popEncoderEvent(encoderEvent &event) {
+  if (!peekEncoderEvent(event))
+    return false;
+
+  encoderQueueTail = encoderQueueTail + 1;
+  return true;
+}
+
+/* Wheel speed estimate, updated for every detent taken off the queue from the
+   detent's own timestamp, so it follows the hand within a detent or two */
+
+// the wheel counts as stopped after this long without a detent; microseconds
+#define WHEEL_AT_REST_AFTER 500000UL
+
+bool wheelTurning = false;
+unsigned long lastDetentTime = 0; // micros()
+unsigned long detentInterval = 0; // smoothed microseconds between detents, 0 if unknown
+
+void trackDetentVelocity(unsigned long time) {
+  unsigned long interval = time - lastDetentTime;
+  lastDetentTime = time;
+
+  if (!wheelTurning || (interval >= WHEEL_AT_REST_AFTER)) {
+    // first detent after a rest; the speed is known from the next one
+    wheelTurning = true;
+    detentInterval = 0;
+  } else if (detentInterval == 0) {
+    detentInterval = interval;
+  } else if (interval > detentInterval) {
+    detentInterval += (interval - detentInterval) >> WHEEL_VELOCITY_SMOOTHING;
+  } else {
+    detentInterval -= (detentInterval - interval) >> WHEEL_VELOCITY_SMOOTHING;
   }
-  else if (result == DIR_CW) {
-    encoderTurned++;
+}
+
+/* Current wheel speed in detents per second. Decays on its own once the wheel
+   slows down, as the time since the last detent becomes the longer interval. */
+uint16_t wheelVelocity() {
+  if (!wheelTurning)
+    return 0;
+
+  unsigned long interval = micros() - lastDetentTime;
+  if (interval >= WHEEL_AT_REST_AFTER) {
+    wheelTurning = false;
+    return 0;
   }
-  else if (result == DIR_CCW) {
-    encoderTurned--;
+
+  if (detentInterval == 0)
+    return 0;
+
+  if (interval < detentInterval)
+    interval = detentInterval;
+
+  return 1000000UL / interval;
+}
+
+/* Take queued detents for as long as they turn the same way as `direction`
+   (or as the first queued detent, if `direction` is 0), up to maxDetents.
+   Returns the signed number taken; negative is CCW. */
+unsigned long oldestTakenDetentTime = 0; // micros() of the first detent the last take returned
+
+int8_t takeEncoderDetents(int8_t direction, uint8_t maxDetents) {
+  int8_t detents = 0;
+  encoderEvent event;
+  while ((abs(detents) < maxDetents) && peekEncoderEvent(event)) {
+    if (direction == 0)
+      direction = event.direction;
+    if (event.direction != direction)
+      break;
+
+    popEncoderEvent(event);
+    if (detents == 0)
+      oldestTakenDetentTime = event.time;
+    trackDetentVelocity(event.time);
+    detents += event.direction;
   }
+  return detents;
+}
+
+uint16_t encoderOverflowCount() {
+  noInterrupts();
+  uint16_t overflows = encoderQueueOverflows;
+  interrupts();
+  return overflows;
 }
 
+uint16_t encoderInvalidCount() {
+  noInterrupts();
+  uint16_t invalid = encoderInvalidTransitions;
+  interrupts();
+  return invalid;
+}
+
+uint16_t encoderBouncedCount() {
+  noInterrupts();
+  uint16_t bounced = encoderBouncedTransitions;
+  interrupts();
+  return bounced;
+}
+
+#ifdef ENABLE_INSTRUMENTATION
+// the encoder's error counts, printed with the timing statistics
+void printEncoderStats() {
+  Serial.print(F("encoder: invalid="));
+  Serial.print(encoderInvalidCount());
+  Serial.print(F(" bounced="));
+  Serial.print(encoderBouncedCount());
+  Serial.print(F(" overflows="));
+  Serial.println(encoderOverflowCount());
+}
+#endif
+
 bool isAccelerated = false;
 
 #endif
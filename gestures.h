@@ -0,0 +1,235 @@
+#ifndef GESTURES_H
+#define GESTURES_H
+
+#include "config.h"
+#include "control_modes.h"
+#include "buttons.h"
+
+/*
+Gesture engine: turns the button edges into gesture events for loop() to act
+on, using the gesture bindings in control_modes.h.
+
+A button without a double tap or hold bound in the current mode does its own
+thing as soon as it is pressed, as if there were no gestures at all
+(GESTURE_TAP_DOWN, then GESTURE_TAP_UP when released). Only when the mode
+binds one of those is the button held back until it is clear which gesture
+it is:
+
+  * released before GESTURE_HOLD_TIME: a tap (GESTURE_TAP), or with a double
+    tap bound, a tap once GESTURE_DOUBLE_TAP_TIME has passed without a second
+    press
+  * pressed again within GESTURE_DOUBLE_TAP_TIME: the double tap
+  * held for GESTURE_HOLD_TIME: the hold, or without one bound, the button's
+    own action after all
+
+Pressing a button while another is held completes a chord if one is bound,
+instead of the button doing its own thing. The held button has already done
+its own thing; if it was being held back it does nothing.
+
+A bound gesture is GESTURE_BINDING_DOWN when recognised and
+GESTURE_BINDING_UP when the button that completed it is released.
+*/
+
+#define GESTURE_TAP_DOWN 0 // the button's own action, held
+#define GESTURE_TAP_UP 1
+#define GESTURE_TAP 2 // the button's own action, pressed and released
+#define GESTURE_BINDING_DOWN 3
+#define GESTURE_BINDING_UP 4
+
+struct gestureEvent {
+  uint8_t kind; // GESTURE_TAP_DOWN ... GESTURE_BINDING_UP
+  uint8_t button; // BUTTON_*
+  const gestureBinding *binding; // in flash; for GESTURE_BINDING_*
+};
+
+// what each button is doing
+#define GESTURE_STATE_IDLE 0
+#define GESTURE_STATE_TAP_HELD 1 // own action sent, waiting for the release
+#define GESTURE_STATE_BINDING_HELD 2 // bound gesture sent, waiting for the release
+#define GESTURE_STATE_WAITING_FOR_HOLD 3 // held back; might become a hold
+#define GESTURE_STATE_WAITING_FOR_DOUBLE_TAP 4 // tapped once; might become a double tap
+#define GESTURE_STATE_CONSUMED 5 // held back and then used in a chord
+
+struct buttonGesture {
+  uint8_t state; // GESTURE_STATE_*
+  unsigned long since; // millis() the state started
+  const gestureBinding *binding; // for GESTURE_STATE_BINDING_HELD
+};
+
+buttonGesture buttonGestures[NUMBER_OF_BUTTONS];
+
+// the buttons waiting for a hold or double tap timer, a bit per BUTTON_*
+uint8_t gestureTimersRunning = 0;
+
+const uint8_t numberOfGestureBindings = sizeof (gestureBindings) / sizeof (gestureBindings[0]);
+
+/* The gestures bound in gesturesModeIndex, a bit per GESTURE_* for each
+   button, so only buttons with bindings ever search the list */
+uint8_t gesturesModeIndex = ALL_MODES;
+uint8_t boundGestures[NUMBER_OF_BUTTONS];
+
+// this loop's events, at most one per button
+gestureEvent gestureEvents[NUMBER_OF_BUTTONS];
+uint8_t gestureEventCount = 0;
+
+bool gestureBindingApplies(const gestureBinding *binding, uint8_t modeIndex) {
+  uint8_t bindingMode = pgm_read_byte(&binding->modeIndex);
+  return (bindingMode == ALL_MODES) || (bindingMode == modeIndex);
+}
+
+/* The binding of a gesture in a mode, or NULL if there is none; heldButton
+   only counts for chords */
+const gestureBinding *findGestureBinding(uint8_t modeIndex, uint8_t gesture, uint8_t button, uint8_t heldButton) {
+  if (!bitRead(boundGestures[button], gesture))
+    return NULL;
+
+  for (uint8_t i = 0; i < numberOfGestureBindings; i++) {
+    const gestureBinding *binding = &gestureBindings[i];
+    if (gestureBindingApplies(binding, modeIndex)
+        && (pgm_read_byte(&binding->gesture) == gesture)
+        && (pgm_read_byte(&binding->button) == button)
+        && ((gesture != GESTURE_CHORD) || (pgm_read_byte(&binding->heldButton) == heldButton)))
+      return binding;
+  }
+  return NULL;
+}
+
+void findBoundGestures(uint8_t modeIndex) {
+  gesturesModeIndex = modeIndex;
+  for (uint8_t b = 0; b < NUMBER_OF_BUTTONS; b++) {
+    boundGestures[b] = 0;
+  }
+  for (uint8_t i = 0; i < numberOfGestureBindings; i++) {
+    const gestureBinding *binding = &gestureBindings[i];
+    if (gestureBindingApplies(binding, modeIndex))
+      bitSet(boundGestures[pgm_read_byte(&binding->button)], pgm_read_byte(&binding->gesture));
+  }
+}
+
+controlAction loadGestureAction(const gestureBinding *binding) {
+  controlAction action;
+  memcpy_P(&action, &binding->action, sizeof (controlAction));
+  return action;
+}
+
+void emitGesture(uint8_t kind, uint8_t button, const gestureBinding *binding) {
+  gestureEvent &event = gestureEvents[gestureEventCount++];
+  event.kind = kind;
+  event.button = button;
+  event.binding = binding;
+}
+
+void startBindingGesture(uint8_t button, const gestureBinding *binding) {
+  buttonGesture &gesture = buttonGestures[button];
+  gesture.state = GESTURE_STATE_BINDING_HELD;
+  gesture.binding = binding;
+  emitGesture(GESTURE_BINDING_DOWN, button, binding);
+}
+
+void gesturePressed(uint8_t button, uint8_t modeIndex, unsigned long now) {
+  buttonGesture &gesture = buttonGestures[button];
+  bitClear(gestureTimersRunning, button);
+
+  // completing a chord with a button that is already down
+  if (bitRead(boundGestures[button], GESTURE_CHORD)) {
+    for (uint8_t held = 0; held < NUMBER_OF_BUTTONS; held++) {
+      if ((held == button) || !buttons[held]->isPressed())
+        continue;
+      const gestureBinding *binding = findGestureBinding(modeIndex, GESTURE_CHORD, button, held);
+      if (binding) {
+        if (buttonGestures[held].state == GESTURE_STATE_WAITING_FOR_HOLD) {
+          buttonGestures[held].state = GESTURE_STATE_CONSUMED;
+          bitClear(gestureTimersRunning, held);
+        }
+        startBindingGesture(button, binding);
+        return;
+      }
+    }
+  }
+
+  if (gesture.state == GESTURE_STATE_WAITING_FOR_DOUBLE_TAP) {
+    const gestureBinding *binding = findGestureBinding(modeIndex, GESTURE_DOUBLE_TAP, button, 0);
+    if (binding) {
+      startBindingGesture(button, binding);
+      return;
+    }
+  }
+
+  if (bitRead(boundGestures[button], GESTURE_DOUBLE_TAP) || bitRead(boundGestures[button], GESTURE_HOLD)) {
+    gesture.state = GESTURE_STATE_WAITING_FOR_HOLD;
+    gesture.since = now;
+    bitSet(gestureTimersRunning, button);
+    return;
+  }
+
+  gesture.state = GESTURE_STATE_TAP_HELD;
+  emitGesture(GESTURE_TAP_DOWN, button, NULL);
+}
+
+void gestureReleased(uint8_t button, unsigned long now) {
+  buttonGesture &gesture = buttonGestures[button];
+
+  switch (gesture.state) {
+  case GESTURE_STATE_TAP_HELD:
+    emitGesture(GESTURE_TAP_UP, button, NULL);
+    break;
+  case GESTURE_STATE_BINDING_HELD:
+    emitGesture(GESTURE_BINDING_UP, button, gesture.binding);
+    break;
+  case GESTURE_STATE_WAITING_FOR_HOLD:
+    if (bitRead(boundGestures[button], GESTURE_DOUBLE_TAP)) {
+      gesture.state = GESTURE_STATE_WAITING_FOR_DOUBLE_TAP;
+      gesture.since = now;
+      bitSet(gestureTimersRunning, button);
+      return;
+    }
+    emitGesture(GESTURE_TAP, button, NULL);
+    break;
+  }
+  gesture.state = GESTURE_STATE_IDLE;
+  bitClear(gestureTimersRunning, button);
+}
+
+void gestureTimers(uint8_t button, uint8_t modeIndex, unsigned long now) {
+  buttonGesture &gesture = buttonGestures[button];
+
+  if ((gesture.state == GESTURE_STATE_WAITING_FOR_HOLD) && (now - gesture.since >= GESTURE_HOLD_TIME)) {
+    bitClear(gestureTimersRunning, button);
+    const gestureBinding *binding = findGestureBinding(modeIndex, GESTURE_HOLD, button, 0);
+    if (binding) {
+      startBindingGesture(button, binding);
+    } else {
+      // only a double tap is bound, and this isn't one
+      gesture.state = GESTURE_STATE_TAP_HELD;
+      emitGesture(GESTURE_TAP_DOWN, button, NULL);
+    }
+  } else if ((gesture.state == GESTURE_STATE_WAITING_FOR_DOUBLE_TAP) && (now - gesture.since >= GESTURE_DOUBLE_TAP_TIME)) {
+    bitClear(gestureTimersRunning, button);
+    gesture.state = GESTURE_STATE_IDLE;
+    emitGesture(GESTURE_TAP, button, NULL);
+  }
+}
+
+/* Turn this loop's button edges and the gesture timers into gestureEvents;
+   to be called after readButtons(). Only the buttons with an edge or a timer
+   running are looked at, so idle buttons cost nothing. */
+void pollGestures(uint8_t modeIndex, unsigned long now) {
+  if (modeIndex != gesturesModeIndex)
+    findBoundGestures(modeIndex);
+
+  gestureEventCount = 0;
+  uint8_t pending = buttonsPressed | buttonsReleased | gestureTimersRunning;
+  for (uint8_t b = 0; pending != 0; b++, pending >>= 1) {
+    if (!(pending & 1))
+      continue;
+    if (bitRead(buttonsPressed, b)) {
+      gesturePressed(b, modeIndex, now);
+    } else if (bitRead(buttonsReleased, b)) {
+      gestureReleased(b, now);
+    } else {
+      gestureTimers(b, modeIndex, now);
+    }
+  }
+}
+
+#endif
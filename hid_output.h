@@ -0,0 +1,235 @@
+#ifndef HID_OUTPUT_H
+#define HID_OUTPUT_H
+
+#include "HID-Project.h"
+
+#include "config.h"
+#include "control_modes.h"
+#include "debugging.h"
+#include "trace.h"
+
+#ifdef ENABLE_HIRES_SCROLL
+  #include "hires_mouse.h"
+#endif
+
+/* Pressing and releasing keys on the USB HID devices, shared by the control
+   mode actions and the macro engine.
+
+   Keyboard and consumer keys are staged and then sent together by
+   sendStagedKeys(), so all the keys of an action reach the host in a single
+   report per device and the host never sees part of a chord, e.g. Ctrl+GUI
+   without the arrow. The consumer report is kept here rather than by
+   HID-Project's Consumer: that holds up to four keys too, but sends a report
+   on every press(), so an action with several consumer keys would go out as
+   one report per key. Don't go back to Consumer.press(). */
+
+boolean keyboardPressed = false; // is Keyboard in currently-pressed state?
+boolean consumerPressed = false; // is Consumer in currently-pressed state?
+
+bool keyboardStaged = false; // Keyboard's report has changes not sent yet
+bool consumerStaged = false; // consumerReport has changes not sent yet
+HID_ConsumerControlReport_Data_t consumerReport = {}; // consumer keys down
+
+/* With instrumentation, every report is counted and the benchmarks (see
+   runBenchmarks()) can mute the output so nothing reaches the host */
+#ifdef ENABLE_INSTRUMENTATION
+uint16_t hidReportCount = 0;
+bool hidOutputMuted = false;
+
+// Count `reports` about to be sent; whether to actually send them
+bool hidReport(uint8_t reports) {
+  hidReportCount += reports;
+  return !hidOutputMuted;
+}
+#else
+  #define hidReport(reports) true
+#endif
+
+/* Put a consumer key into the staged report, or take it out. Keys beyond
+   the four the report holds are dropped. */
+void stageConsumerKey(uint16_t keyCode, bool down) {
+  uint8_t count = sizeof (consumerReport.keys) / sizeof (consumerReport.keys[0]);
+  for (uint8_t i = 0; i < count; i++) {
+    if (consumerReport.keys[i] == keyCode) {
+      if (!down) {
+        consumerReport.keys[i] = 0;
+        consumerStaged = true;
+      }
+      return;
+    }
+  }
+  if (!down)
+    return;
+
+  for (uint8_t i = 0; i < count; i++) {
+    if (consumerReport.keys[i] == 0) {
+      consumerReport.keys[i] = keyCode;
+      consumerStaged = true;
+      return;
+    }
+  }
+}
+
+// Send one report for each device whose keys changed since the last one
+void sendStagedKeys() {
+  if (keyboardStaged) {
+    if (hidReport(1))
+      Keyboard.send();
+    keyboardStaged = false;
+  }
+
+  if (consumerStaged) {
+    if (hidReport(1))
+      HID().SendReport(HID_REPORTID_CONSUMERCONTROL, &consumerReport, sizeof (consumerReport));
+    consumerStaged = false;
+  }
+}
+
+void releaseKeys() {
+  setIndicatorLed(0);
+
+  if (keyboardPressed || consumerPressed)
+    trace(TRACE_RELEASE_ALL, keyboardPressed | (consumerPressed << 1), 0);
+
+  if (keyboardPressed) {
+    Keyboard.removeAll();
+    keyboardStaged = true;
+    keyboardPressed = false;
+  }
+
+  if (consumerPressed) {
+    memset(&consumerReport, 0, sizeof (consumerReport));
+    consumerStaged = true;
+    consumerPressed = false;
+  }
+
+  sendStagedKeys();
+}
+
+// Scroll the mouse wheel, split over as few reports as the wheel field allows
+void scrollMouse(int16_t amount) {
+  trace(TRACE_SCROLL, 0, amount);
+  while (amount != 0) {
+    int8_t step = constrain(amount, -127, 127);
+    if (hidReport(1))
+      Mouse.move(0, 0, step);
+    amount -= step;
+  }
+}
+
+/* Scroll the mouse wheel in 1/HIRES_SCROLL_MULTIPLIER lines. Unless the host
+   has switched the high-resolution mouse to fractions of a line, whole lines
+   are scrolled and the rest is kept for the next scroll. */
+int16_t hiResScrollRemainder = 0;
+
+void scrollMouseHiRes(int16_t amount) {
+  #ifdef ENABLE_HIRES_SCROLL
+    if (HiResMouse.highResolution()) {
+      trace(TRACE_SCROLL, 1, amount);
+      while (amount != 0) {
+        int8_t step = constrain(amount, -127, 127);
+        if (hidReport(1))
+          HiResMouse.scroll(step);
+        amount -= step;
+      }
+      return;
+    }
+  #endif
+
+  hiResScrollRemainder += amount;
+  int16_t lines = hiResScrollRemainder / HIRES_SCROLL_MULTIPLIER;
+  hiResScrollRemainder -= lines * HIRES_SCROLL_MULTIPLIER;
+  scrollMouse(lines);
+}
+
+// stageKey() scroll amount meaning "as much as the key scrolls by default"
+#define DEFAULT_SCROLL_AMOUNT 0xFFFF
+
+/* How far a scroll key moves the wheel by default: MOUSE_SCROLL_AMOUNT lines,
+   or HIRES_SCROLL_AMOUNT units for the high-resolution scrolls */
+uint16_t defaultScrollAmount(actionKeypress key) {
+  return (key.keyCode() & MOUSE_HIRES) ? HIRES_SCROLL_AMOUNT : MOUSE_SCROLL_AMOUNT;
+}
+
+/* Stage a keyboard or consumer key to go down with the next
+   sendStagedKeys(). Mouse actions are complete in themselves and sent at
+   once, after whatever was staged before them: a click is pressed and
+   released, and a scroll moves the wheel by scrollAmount, in lines or for
+   high-resolution scrolls in 1/HIRES_SCROLL_MULTIPLIER lines. */
+void stageKey(actionKeypress key, uint16_t scrollAmount) {
+  uint8_t hidType = key.hidType();
+  uint16_t keyCode = key.keyCode();
+
+  trace(TRACE_KEY_PRESS, 0, key.packed);
+
+  debugf("HID_TYPE: ");
+  debugfmt(keyCode, HEX);
+
+  if (hidType == CONSUMER_HID_TYPE) {
+    debugfln(" CONSUMER_HID_TYPE");
+
+    stageConsumerKey(keyCode, true);
+    consumerPressed = true;
+  } else if (hidType == MOUSE_HID_TYPE) {
+    debugfln(" MOUSE_HID_TYPE");
+
+    // e.g. a modifier staged for a click has to be down before it
+    sendStagedKeys();
+
+    if (scrollAmount == DEFAULT_SCROLL_AMOUNT)
+      scrollAmount = defaultScrollAmount(key);
+
+    if ((keyCode & MOUSE_HIRES) && bitRead(keyCode, 6)) {
+      debugfln("hi-res scrolling down");
+      scrollMouseHiRes(scrollAmount);
+    } else if ((keyCode & MOUSE_HIRES) && bitRead(keyCode, 5)) {
+      debugfln("hi-res scrolling up");
+      scrollMouseHiRes(-(int16_t)scrollAmount);
+    } else if (bitRead(keyCode, 6)) {
+      debugfln("scrolling down");
+      scrollMouse(scrollAmount);
+    } else if (bitRead(keyCode, 5)) {
+      debugfln("scrolling up");
+      scrollMouse(-(int16_t)scrollAmount);
+    } else if (bitRead(keyCode, 4)) {
+      debugfln("left click");
+      if (hidReport(2)) // pressed and released
+        Mouse.click(MOUSE_LEFT);
+    } else if (bitRead(keyCode, 3)) {
+      debugfln("right click");
+      if (hidReport(2)) // pressed and released
+        Mouse.click(MOUSE_RIGHT);
+    } else if (bitRead(keyCode, 2)) {
+      debugfln("middle click");
+      if (hidReport(2)) // pressed and released
+        Mouse.click(MOUSE_MIDDLE);
+    }
+  } else if (hidType == KEYBOARD_HID_TYPE) {
+    debugfln(" KEYBOARD_HID_TYPE");
+
+    Keyboard.add((KeyboardKeycode)keyCode);
+    keyboardStaged = true;
+    keyboardPressed = true;
+  }
+}
+
+// Press a single key and leave it down
+void pressKey(actionKeypress key, uint16_t scrollAmount) {
+  stageKey(key, scrollAmount);
+  sendStagedKeys();
+}
+
+// Release one key pressed with pressKey(); other keys stay down
+void releaseKey(actionKeypress key) {
+  trace(TRACE_KEY_RELEASE, 0, key.packed);
+
+  if (key.hidType() == CONSUMER_HID_TYPE) {
+    stageConsumerKey(key.keyCode(), false);
+  } else if (key.hidType() == KEYBOARD_HID_TYPE) {
+    Keyboard.remove((KeyboardKeycode)key.keyCode());
+    keyboardStaged = true;
+  }
+  sendStagedKeys();
+}
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef HIRES_MOUSE_H
+#define HIRES_MOUSE_H
+
+#include "HID-Project.h"
+#include "PluggableUSB.h"
+
+#include "config.h"
+
+/*
+A second USB mouse with a high-resolution wheel, enabled with
+ENABLE_HIRES_SCROLL in config.h and used by the MOUSE_HIRES_SCROLL_* actions.
+
+Its wheel is declared together with a Resolution Multiplier feature (HID
+Usage Tables, Generic Desktop 0x48) going from 1 to HIRES_SCROLL_MULTIPLIER.
+Hosts that support it (Windows, Linux) set the multiplier to its maximum
+with a SET_REPORT request and then treat each wheel unit as
+1/HIRES_SCROLL_MULTIPLIER of a line. The Arduino core's HID() stalls
+SET_REPORT, so like HID-Project's single-report devices this mouse is a USB
+interface of its own (PluggableUSB) and answers the feature report requests
+itself. Until the host sets the multiplier, highResolution() is false and
+the caller should scroll whole lines instead.
+
+The report has an X and Y axis, always 0, so that hosts accept it as a
+pointing device. Being alone on its interface, it has no report ID.
+
+Input report: int8 x, int8 y, int8 wheel
+Feature report: resolution multiplier in bits 0-1, 0 for 1 and 1 for
+HIRES_SCROLL_MULTIPLIER
+*/
+
+static_assert((HIRES_SCROLL_MULTIPLIER >= 2) && (HIRES_SCROLL_MULTIPLIER <= 127), "HIRES_SCROLL_MULTIPLIER must be 2 to 127");
+
+const uint8_t hiResMouseDescriptor[] PROGMEM = {
+  0x05, 0x01,                    // USAGE_PAGE (Generic Desktop)
+  0x09, 0x02,                    // USAGE (Mouse)
+  0xa1, 0x01,                    // COLLECTION (Application)
+  0x09, 0x01,                    //   USAGE (Pointer)
+  0xa1, 0x00,                    //   COLLECTION (Physical)
+  0x09, 0x30,                    //     USAGE (X)
+  0x09, 0x31,                    //     USAGE (Y)
+  0x15, 0x81,                    //     LOGICAL_MINIMUM (-127)
+  0x25, 0x7f,                    //     LOGICAL_MAXIMUM (127)
+  0x75, 0x08,                    //     REPORT_SIZE (8)
+  0x95, 0x02,                    //     REPORT_COUNT (2)
+  0x81, 0x06,                    //     INPUT (Data,Var,Rel)
+  0xa1, 0x02,                    //     COLLECTION (Logical)
+  0x09, 0x48,                    //       USAGE (Resolution Multiplier)
+  0x15, 0x00,                    //       LOGICAL_MINIMUM (0)
+  0x25, 0x01,                    //       LOGICAL_MAXIMUM (1)
+  0x35, 0x01,                    //       PHYSICAL_MINIMUM (1)
+  0x45, HIRES_SCROLL_MULTIPLIER, //       PHYSICAL_MAXIMUM
+  0x75, 0x02,                    //       REPORT_SIZE (2)
+  0x95, 0x01,                    //       REPORT_COUNT (1)
+  0xb1, 0x02,                    //       FEATURE (Data,Var,Abs)
+  0x35, 0x00,                    //       PHYSICAL_MINIMUM (0)
+  0x45, 0x00,                    //       PHYSICAL_MAXIMUM (0)
+  0x09, 0x38,                    //       USAGE (Wheel)
+  0x15, 0x81,                    //       LOGICAL_MINIMUM (-127)
+  0x25, 0x7f,                    //       LOGICAL_MAXIMUM (127)
+  0x75, 0x08,                    //       REPORT_SIZE (8)
+  0x95, 0x01,                    //       REPORT_COUNT (1)
+  0x81, 0x06,                    //       INPUT (Data,Var,Rel)
+  0xc0,                          //     END_COLLECTION
+  0x75, 0x06,                    //     REPORT_SIZE (6)
+  0x95, 0x01,                    //     REPORT_COUNT (1)
+  0xb1, 0x03,                    //     FEATURE (Cnst,Var,Abs); pads the multiplier to a byte
+  0xc0,                          //   END_COLLECTION
+  0xc0                           // END_COLLECTION
+};
+
+struct hiResMouseReport {
+  int8_t x;
+  int8_t y;
+  int8_t wheel;
+};
+
+/* Like the HID-Project devices, the interface is plugged in from the
+   constructor of a global object, so it is in place before the host
+   enumerates the device */
+class HiResMouse_ : public PluggableUSBModule {
+public:
+  HiResMouse_() : PluggableUSBModule(1, 1, epType) {
+    epType[0] = EP_TYPE_INTERRUPT_IN;
+    PluggableUSB().plug(this);
+  }
+
+  // has the host set the resolution multiplier, making a wheel unit a fraction of a line?
+  bool highResolution() const {
+    return resolutionMultiplier & 0x03;
+  }
+
+  // Scroll by `units` of 1/HIRES_SCROLL_MULTIPLIER line, if highResolution()
+  void scroll(int8_t units) {
+    hiResMouseReport report = {0, 0, units};
+    USB_Send(pluggedEndpoint | TRANSFER_RELEASE, &report, sizeof(report));
+  }
+
+protected:
+  int getInterface(uint8_t *interfaceCount) override {
+    *interfaceCount += 1;
+    HIDDescriptor hidInterface = {
+      D_INTERFACE(pluggedInterface, 1, USB_DEVICE_CLASS_HUMAN_INTERFACE, HID_SUBCLASS_NONE, HID_PROTOCOL_NONE),
+      D_HIDREPORT(sizeof(hiResMouseDescriptor)),
+      D_ENDPOINT(USB_ENDPOINT_IN(pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, 0x01)
+    };
+    return USB_SendControl(0, &hidInterface, sizeof(hidInterface));
+  }
+
+  int getDescriptor(USBSetup &setup) override {
+    if ((setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE)
+        || (setup.wValueH != HID_REPORT_DESCRIPTOR_TYPE) || (setup.wIndex != pluggedInterface))
+      return 0;
+
+    // a host enumerating the device again sets everything again, or not at all
+    protocol = HID_REPORT_PROTOCOL;
+    resolutionMultiplier = 0;
+    return USB_SendControl(TRANSFER_PGM, hiResMouseDescriptor, sizeof(hiResMouseDescriptor));
+  }
+
+  bool setup(USBSetup &setup) override {
+    if (setup.wIndex != pluggedInterface)
+      return false;
+
+    if (setup.bmRequestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE) {
+      switch (setup.bRequest) {
+      case HID_GET_REPORT:
+        if (setup.wValueH != HID_REPORT_TYPE_FEATURE)
+          return false;
+        USB_SendControl(0, &resolutionMultiplier, sizeof(resolutionMultiplier));
+        return true;
+      case HID_GET_PROTOCOL:
+        USB_SendControl(0, &protocol, sizeof(protocol));
+        return true;
+      case HID_GET_IDLE:
+        USB_SendControl(0, &idle, sizeof(idle));
+        return true;
+      }
+    }
+
+    if (setup.bmRequestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE) {
+      switch (setup.bRequest) {
+      case HID_SET_REPORT:
+        if ((setup.wValueH != HID_REPORT_TYPE_FEATURE) || (setup.wLength != sizeof(resolutionMultiplier)))
+          return false;
+        USB_RecvControl(&resolutionMultiplier, sizeof(resolutionMultiplier));
+        return true;
+      case HID_SET_PROTOCOL:
+        protocol = setup.wValueL;
+        return true;
+      case HID_SET_IDLE:
+        idle = setup.wValueL;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  EPTYPE_DESCRIPTOR_SIZE epType[1];
+  uint8_t protocol = HID_REPORT_PROTOCOL;
+  uint8_t idle = 1;
+  uint8_t resolutionMultiplier = 0; // the feature report, as the host last set it
+};
+
+HiResMouse_ HiResMouse;
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef HOST_CONTROL_H
+#define HOST_CONTROL_H
+
+#include "config.h"
+#include "mode_storage.h"
+
+/*
+Lets software on the host follow what the user is doing: select a control
+mode, e.g. the one for the application in the foreground, and show a short
+transient label in place of the quick-toggle label. Both arrive as serial
+commands (see serial_commands.h and tools/host_context.py) and are recorded
+here for loop() to apply.
+*/
+
+#define NO_MODE_REQUEST 0xFF
+
+// mode the host asked for, NO_MODE_REQUEST if none is waiting
+uint8_t hostRequestedMode = NO_MODE_REQUEST;
+
+char transientLabel[MAX_LABEL_LENGTH] = ""; // empty when none is shown
+unsigned long transientLabelUntil = 0; // millis()
+uint8_t transientLabelVersion = 0; // changes whenever the label does
+
+void setTransientLabel(const char *label) {
+  strncpy(transientLabel, label, MAX_LABEL_LENGTH - 1);
+  transientLabel[MAX_LABEL_LENGTH - 1] = '\0';
+  transientLabelUntil = millis() + TRANSIENT_LABEL_TIME;
+  transientLabelVersion++;
+}
+
+// Remove the transient label once its time is up
+void expireTransientLabel(unsigned long currentMillis) {
+  if ((transientLabel[0] == '\0') || ((long)(currentMillis - transientLabelUntil) < 0))
+    return;
+
+  transientLabel[0] = '\0';
+  transientLabelVersion++;
+}
+
+/* Find the mode the host means: all digits is an index, anything else a
+   mode name, ignoring case. Returns NO_MODE_REQUEST if there is no such
+   mode. */
+uint8_t findRequestedMode(const char *request) {
+  if (request[0] == '\0')
+    return NO_MODE_REQUEST;
+
+  if (strspn(request, "0123456789") == strlen(request)) {
+    // at most 3 digits, so the number can't overflow on its way to a mode index
+    if (strlen(request) > 3)
+      return NO_MODE_REQUEST;
+    uint16_t index = atoi(request);
+    return (index < numberOfModes) ? index : NO_MODE_REQUEST;
+  }
+
+  char modeName[MAX_LABEL_LENGTH];
+  for (uint8_t i = 0; i < numberOfModes; i++) {
+    if (strcasecmp(loadModeName(modeName, i), request) == 0)
+      return i;
+  }
+  return NO_MODE_REQUEST;
+}
+
+#endif
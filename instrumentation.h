@@ -0,0 +1,241 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "config.h"
+
+/*
+Opt-in timing statistics, enabled with ENABLE_INSTRUMENTATION in config.h.
+
+For each measured quantity a count, min, max and a histogram are kept. The
+histogram has a bucket per power of two: bucket i counts values from 2^(i-1)
+up to 2^i - 1 (bucket 0 counts zeros), and the last bucket also counts
+everything larger.
+
+Wake latency is measured from the MCU waking from idle sleep (see power.h) to
+the first HID report sent after it.
+
+The encoder interrupt is timed in CPU cycles with Timer1, which is set to run
+freely at the CPU clock; everything else is timed with micros().
+
+Send 's' over the serial port to print the statistics, 'r' to reset them
+(see serial_commands.h).
+
+Send 'b' to run the benchmarks (runBenchmarks() in the main sketch), which
+time the display and dispatch paths in CPU cycles for every control mode with
+every layout. Long runs are timed with cycleCount(), which extends Timer1 to
+32 bits by counting its overflows.
+
+With instrumentation disabled all of the instrument* macros compile to
+nothing.
+*/
+
+#define LOOP_PERIOD_STAT 0 // microseconds between the starts of loop()
+#define DISPLAY_UPDATE_STAT 1 // microseconds spent in updateDisplay()
+#define ENCODER_ISR_STAT 2 // CPU cycles spent in the encoder interrupt
+#define DETENT_LATENCY_STAT 3 // microseconds from wheel detent to HID report
+#define DISPLAY_SLICE_STAT 4 // microseconds spent drawing per loop, when drawing
+#define WAKE_LATENCY_STAT 5 // microseconds from waking from idle sleep to HID report
+#define NUMBER_OF_STATS 6
+
+#define INSTRUMENTATION_BUCKETS 16
+
+#ifdef ENABLE_INSTRUMENTATION
+
+struct timingStat {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint16_t buckets[INSTRUMENTATION_BUCKETS];
+};
+
+const char loopPeriodStatName[] PROGMEM = "loop period (us)";
+const char displayUpdateStatName[] PROGMEM = "display update (us)";
+const char encoderIsrStatName[] PROGMEM = "encoder ISR (cycles)";
+const char detentLatencyStatName[] PROGMEM = "detent to report (us)";
+const char displaySliceStatName[] PROGMEM = "display slice (us)";
+const char wakeLatencyStatName[] PROGMEM = "wake to report (us)";
+
+const char * const statNames[NUMBER_OF_STATS] PROGMEM = {
+  loopPeriodStatName,
+  displayUpdateStatName,
+  encoderIsrStatName,
+  detentLatencyStatName,
+  displaySliceStatName,
+  wakeLatencyStatName
+};
+
+// ENCODER_ISR_STAT is only written from the interrupt itself
+volatile timingStat timingStats[NUMBER_OF_STATS];
+
+unsigned long lastLoopStart = 0;
+
+// when the MCU last woke from idle sleep, and whether a report was sent since
+unsigned long lastWake = 0;
+bool reportedSinceWake = true;
+
+// set by the 'b' serial command; the benchmarks run from loop()
+bool benchmarkRequested = false;
+
+volatile uint16_t timer1Overflows = 0;
+
+#ifndef HOST_SIMULATION
+ISR(TIMER1_OVF_vect) {
+  timer1Overflows++;
+}
+#endif
+
+// CPU cycles since Timer1 was started; wraps after about 4.5 minutes at 16MHz
+uint32_t cycleCount() {
+  noInterrupts();
+  uint16_t low = TCNT1;
+  uint16_t high = timer1Overflows;
+  // an overflow that happened since interrupts were disabled isn't counted yet
+  if ((TIFR1 & (1 << TOV1)) && (low < 0x8000))
+    high++;
+  interrupts();
+  return ((uint32_t)high << 16) | low;
+}
+
+void resetTimingStats() {
+  noInterrupts();
+  for (uint8_t i = 0; i < NUMBER_OF_STATS; i++) {
+    timingStats[i].count = 0;
+    timingStats[i].min = 0xFFFFFFFF;
+    timingStats[i].max = 0;
+    for (uint8_t b = 0; b < INSTRUMENTATION_BUCKETS; b++) {
+      timingStats[i].buckets[b] = 0;
+    }
+  }
+  interrupts();
+}
+
+// to be called from inside main setup()
+void instrumentationSetup() {
+  // Timer1 free-running at the CPU clock, as a cycle counter
+  TCCR1A = 0;
+  TCCR1B = (1 << CS10);
+  TIMSK1 = (1 << TOIE1);
+
+  resetTimingStats();
+}
+
+void recordTiming(uint8_t stat, uint32_t value) {
+  volatile timingStat &s = timingStats[stat];
+
+  s.count++;
+  if (value < s.min) s.min = value;
+  if (value > s.max) s.max = value;
+
+  uint8_t bucket = 0;
+  while ((value > 0) && (bucket < INSTRUMENTATION_BUCKETS - 1)) {
+    value >>= 1;
+    bucket++;
+  }
+  if (s.buckets[bucket] < 0xFFFF)
+    s.buckets[bucket]++;
+}
+
+void printTimingStats() {
+  for (uint8_t i = 0; i < NUMBER_OF_STATS; i++) {
+    timingStat s;
+    noInterrupts();
+    s.count = timingStats[i].count;
+    s.min = timingStats[i].min;
+    s.max = timingStats[i].max;
+    for (uint8_t b = 0; b < INSTRUMENTATION_BUCKETS; b++) {
+      s.buckets[b] = timingStats[i].buckets[b];
+    }
+    interrupts();
+
+    Serial.print((const __FlashStringHelper *)pgm_read_ptr(&statNames[i]));
+    Serial.print(F(": n="));
+    Serial.print(s.count);
+    if (s.count > 0) {
+      Serial.print(F(" min="));
+      Serial.print(s.min);
+      Serial.print(F(" max="));
+      Serial.print(s.max);
+    }
+    Serial.println();
+
+    // bucket counts, labelled with the upper bound of each bucket
+    for (uint8_t b = 0; b < INSTRUMENTATION_BUCKETS; b++) {
+      if (s.buckets[b] == 0)
+        continue;
+      Serial.print(F("  <"));
+      if (b == INSTRUMENTATION_BUCKETS - 1) {
+        Serial.print(F("inf"));
+      } else {
+        Serial.print(1UL << b);
+      }
+      Serial.print(F(": "));
+      Serial.println(s.buckets[b]);
+    }
+  }
+}
+
+/* Print one benchmark result: cycles and rate per operation, and the display
+   bytes and HID reports per operation when there were any */
+void printBenchmark(const __FlashStringHelper *name, uint32_t cycles, uint16_t ops, uint32_t displayBytes, uint16_t hidReports) {
+  uint32_t cyclesPerOp = cycles / ops;
+  Serial.print(F("  "));
+  Serial.print(name);
+  Serial.print(F(": "));
+  Serial.print(cyclesPerOp);
+  Serial.print(F(" cycles, "));
+  Serial.print(F_CPU / (cyclesPerOp ? cyclesPerOp : 1));
+  Serial.print(F(" ops/s"));
+  if (displayBytes > 0) {
+    Serial.print(F(", "));
+    Serial.print(displayBytes / ops);
+    Serial.print(F(" display bytes"));
+  }
+  if (hidReports > 0) {
+    Serial.print(F(", "));
+    Serial.print((float)hidReports / ops, 1);
+    Serial.print(F(" HID reports"));
+  }
+  Serial.println();
+}
+
+// to be called first thing in loop()
+void instrumentLoopStart() {
+  unsigned long now = micros();
+  if (lastLoopStart != 0)
+    recordTiming(LOOP_PERIOD_STAT, now - lastLoopStart);
+  lastLoopStart = now;
+}
+
+// to be called on waking from idle sleep
+void instrumentWake() {
+  lastWake = micros();
+  reportedSinceWake = false;
+}
+
+// to be called when a HID report is sent
+void instrumentReport() {
+  if (reportedSinceWake)
+    return;
+  recordTiming(WAKE_LATENCY_STAT, micros() - lastWake);
+  reportedSinceWake = true;
+}
+
+#define instrumentMicrosStart(var) unsigned long var = micros()
+#define instrumentMicrosEnd(stat, var) recordTiming(stat, micros() - (var))
+#define instrumentCyclesStart(var) uint16_t var = TCNT1
+#define instrumentCyclesEnd(stat, var) recordTiming(stat, (uint16_t)(TCNT1 - (var)))
+
+#else
+
+#define instrumentationSetup()
+#define instrumentLoopStart()
+#define instrumentWake()
+#define instrumentReport()
+#define instrumentMicrosStart(var)
+#define instrumentMicrosEnd(stat, var)
+#define instrumentCyclesStart(var)
+#define instrumentCyclesEnd(stat, var)
+
+#endif
+
+#endif
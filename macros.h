@@ -0,0 +1,104 @@
+#ifndef MACROS_H
+#define MACROS_H
+
+#include "config.h"
+#include "control_modes.h"
+#include "hid_output.h"
+#include "debugging.h"
+
+/*
+Macro engine. A macro is a list of steps in flash, run one step at a time
+from loop() so the controller keeps reading the buttons and the wheel while
+it plays. Consecutive steps are MACRO_STEP_GAP microseconds apart, measured
+from when the previous step was actually sent, so the host sees each report
+separately without the controller waiting on a full USB endpoint.
+
+Macros are defined in control_modes.h and started by a MACRO_KEY(index) key
+in a control mode action, where index is the position of the macro in
+macroList. Once started a macro runs to its end; releasing the button does
+not stop it, but sending another action does. Whatever the macro left pressed
+is released when it ends or is stopped. Wheel actions wait for the running
+macro to finish; the detents are kept and sent together afterwards.
+*/
+
+const macroStep *macroNextStep = NULL; // in flash; NULL if no macro is running
+unsigned long macroNextStepAt = 0; // micros()
+uint16_t macroTapKey = 0; // key of a tap waiting for its release, 0 if none
+
+bool macroRunning() {
+  return macroNextStep != NULL;
+}
+
+// Stop the running macro, if any, and release what it left pressed
+void stopMacro() {
+  if (!macroRunning())
+    return;
+
+  debugfln("Macro stopped");
+  macroNextStep = NULL;
+  macroTapKey = 0;
+  releaseKeys();
+}
+
+const uint8_t numberOfMacros = sizeof (macroList) / sizeof (macroList[0]);
+
+void startMacro(uint8_t macroIndex) {
+  stopMacro();
+  if (macroIndex >= numberOfMacros)
+    return;
+
+  debugf("Macro ");
+  debug(macroIndex);
+  debugfln(" started");
+  macroNextStep = (const macroStep *)pgm_read_ptr(&macroList[macroIndex]);
+  macroNextStepAt = micros();
+}
+
+/* Send the next step of the running macro if it is due; to be called once
+   per loop */
+void serviceMacro() {
+  if (!macroRunning())
+    return;
+
+  unsigned long now = micros();
+  if ((long)(now - macroNextStepAt) < 0)
+    return;
+
+  macroNextStepAt = now + MACRO_STEP_GAP;
+
+  if (macroTapKey != 0) {
+    releaseKey(actionKeypress(macroTapKey));
+    macroTapKey = 0;
+    return;
+  }
+
+  uint8_t op = pgm_read_byte(&macroNextStep->op);
+  uint16_t value = pgm_read_word(&macroNextStep->value);
+  macroNextStep++;
+
+  switch (op) {
+  case MACRO_PRESS:
+    pressKey(actionKeypress(value), DEFAULT_SCROLL_AMOUNT);
+    break;
+  case MACRO_RELEASE:
+    releaseKey(actionKeypress(value));
+    break;
+  case MACRO_TAP:
+    pressKey(actionKeypress(value), DEFAULT_SCROLL_AMOUNT);
+    macroTapKey = value;
+    break;
+  case MACRO_WAIT:
+    macroNextStepAt = now + value * 1000UL;
+    break;
+  case MACRO_RELEASE_ALL:
+    releaseKeys();
+    break;
+  default: // MACRO_END
+    debugfln("Macro finished");
+    macroNextStep = NULL;
+    releaseKeys();
+    break;
+  }
+}
+
+#endif
@@ -1,8 +1,11 @@
 #ifndef MCU_H
 #define MCU_H
 
-// #define ARDUINO_MICRO
-#define SPARKFUN_PRO_MICRO // https://learn.sparkfun.com/tutorials/pro-micro--fio-v3-hookup-guide
+// HOST_SIMULATION is not a real board and is passed by the host build; see below
+#ifndef HOST_SIMULATION
+  // #define ARDUINO_MICRO
+  #define SPARKFUN_PRO_MICRO // https://learn.sparkfun.com/tutorials/pro-micro--fio-v3-hookup-guide
+#endif
 
 #ifdef ARDUINO_MICRO
   // SDA is 2, SCL is 3
@@ -57,4 +60,24 @@
 
 #endif
 
+/* For compiling the sketch on a desktop machine against stand-in versions of
+   the Arduino core and libraries, which provide the clock and pin states (see
+   tests/host). There are no encoder interrupts; the stand-in calls
+   decodeEncoder() (encoder.h) itself when it changes the encoder pins. */
+#ifdef HOST_SIMULATION
+  #define MIDDLE_PIN 7
+  #define UP_PIN 10
+  #define DOWN_PIN 4
+  #define LEFT_PIN 5
+  #define RIGHT_PIN 6
+  #define ENC_PIN_A 8
+  #define ENC_PIN_B 9
+
+  void mcuSetup() {
+  }
+
+  void setIndicatorLed(bool state) {
+  }
+#endif
+
 #endif
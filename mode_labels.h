@@ -0,0 +1,37 @@
+// Generated by tools/mode_labels.py from control_modes.h; do not edit
+#ifndef MODE_LABELS_H
+#define MODE_LABELS_H
+
+// the empty label first, at offset 0
+constexpr char modeLabels[] PROGMEM =
+  "\0"
+  "Volume\0"
+  "Mute\0"
+  "-\0"
+  "+\0"
+  "Media\0"
+  "Prev\n<<\0"
+  "Next\n>>\0"
+  "Play\nPause\0"
+  "VLC\0"
+  "Scrub\0"
+  "<\0"
+  ">\0"
+  "<<\0"
+  ">>\0"
+  "YouTube\0"
+  "Seek\n<<\0"
+  "Seek\n>>\0"
+  "Mouse\0"
+  "Scroll\0"
+  "Left\nBtn\0"
+  "Right\nBtn\0"
+  "Mid\nBtn\0"
+  "^\0"
+  "_\0"
+  "System\0"
+  "Bright\0"
+  "Ext\n-\0"
+  "Ext\n+\0";
+
+#endif
@@ -0,0 +1,466 @@
+#ifndef MODE_STORAGE_H
+#define MODE_STORAGE_H
+
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#include "config.h"
+#include "control_modes.h"
+#include "debugging.h"
+
+/*
+Control modes can also be kept in EEPROM, in a compact binary "mode image"
+that can be replaced over the serial port without reflashing (see
+tools/encode_modes.py). If the EEPROM holds no valid image, the compiled-in
+controlModeList is used instead.
+
+The EEPROM from MODE_IMAGE_ADDRESS holds a slot byte and then two image
+slots of MODE_IMAGE_CAPACITY bytes each. The slot byte says which slot holds
+the image in use (0 or 1; anything else means none). An upload goes into the
+other slot and the slot byte is only changed once the new image has been
+checked, so the old image stays in use until then, and stays valid if the
+upload fails or power is lost part way through.
+
+Nothing but a small cache is kept in RAM: for the few modes in use (normally
+the current, previous and quick-toggle modes) the offset of each field in the
+image is remembered, and the field itself is read from EEPROM when needed.
+
+Image format, version 1. Numbers are little-endian.
+
+  header, MODE_IMAGE_HEADER_SIZE bytes:
+    'S' 'W'       magic
+    uint8         version, MODE_IMAGE_VERSION
+    uint8         number of modes
+    uint16        length of the whole image, header included
+    uint16        CRC-16 of everything after the header (avr-libc
+                  _crc16_update: polynomial 0xA001, starting from 0xFFFF)
+  uint16[number of modes]   image offset of each mode
+  modes, each:
+    label         name
+    label         wheelName
+    action        left, right, middle, wheelCW, wheelCCW, wheelCWAccel,
+                  wheelCCWAccel, in that order
+    uint8         number of acceleration curve points, 0 to ACCEL_CURVE_POINTS
+    {uint16 detentsPerSecond, uint16 percent}[number of points]
+
+  label:  uint8 length, less than MAX_LABEL_LENGTH, then that many characters
+          without a terminator
+  action: label name, uint8 modeMask, uint8 number of keys (up to
+          MAX_KEYS_PER_ACTION), uint16[number of keys] packed as in
+          actionKeypress
+
+An unbound action is an empty name, a modeMask of 0 and no keys. A mode with
+no curve points is not accelerated.
+
+The whole image is checked when it is loaded, so reading fields afterwards
+needs no bounds checks.
+*/
+
+#define MODE_IMAGE_VERSION 1
+#define MODE_IMAGE_HEADER_SIZE 8
+#define MODE_IMAGE_SLOTS 2
+#define MODE_IMAGE_CAPACITY ((E2END - MODE_IMAGE_ADDRESS) / MODE_IMAGE_SLOTS)
+#define NO_MODE_IMAGE_SLOT 0xFF
+
+#define FLASH_MODE_COUNT (sizeof (controlModeList) / sizeof (controlModeList[0]))
+
+#define NUMBER_OF_ACTION_SLOTS 7
+#define NO_CACHED_MODE 0xFF
+
+uint8_t numberOfModes = FLASH_MODE_COUNT;
+
+// number of modes in the EEPROM image, 0 when the built-in modes are in use
+uint8_t storedModeCount = 0;
+uint16_t modeImageLength = 0;
+uint8_t modeImageSlot = NO_MODE_IMAGE_SLOT;
+
+// EEPROM address of the image imageByte() reads from
+uint16_t modeImageBase = MODE_IMAGE_ADDRESS + 1;
+
+// set whenever the mode list is replaced; cleared by the sketch
+bool modeListChanged = false;
+
+uint16_t modeImageSlotAddress(uint8_t slot) {
+  return MODE_IMAGE_ADDRESS + 1 + slot * MODE_IMAGE_CAPACITY;
+}
+
+uint8_t imageByte(uint16_t offset) {
+  return eeprom_read_byte((const uint8_t *)(modeImageBase + offset));
+}
+
+uint16_t imageWord(uint16_t offset) {
+  return imageByte(offset) | ((uint16_t)imageByte(offset + 1) << 8);
+}
+
+// Where the fields of one mode are in the image
+struct modeCacheEntry {
+  uint8_t modeIndex; // NO_CACHED_MODE if the entry is unused
+  uint16_t lastUsed;
+  uint16_t name;
+  uint16_t wheelName;
+  uint16_t actions[NUMBER_OF_ACTION_SLOTS]; // by actionSlot
+  uint16_t curve;
+};
+
+modeCacheEntry modeCache[MODE_CACHE_SIZE];
+uint16_t modeCacheClock = 0;
+
+void clearModeCache() {
+  for (uint8_t i = 0; i < MODE_CACHE_SIZE; i++) {
+    modeCache[i].modeIndex = NO_CACHED_MODE;
+  }
+}
+
+bool skipLabel(uint16_t &at, uint16_t end) {
+  if (at >= end)
+    return false;
+  uint8_t length = imageByte(at);
+  if (length >= MAX_LABEL_LENGTH)
+    return false;
+  at += 1 + length;
+  return at <= end;
+}
+
+bool skipAction(uint16_t &at, uint16_t end) {
+  if (!skipLabel(at, end) || (at + 2 > end))
+    return false;
+  uint8_t keyCount = imageByte(at + 1);
+  if (keyCount > MAX_KEYS_PER_ACTION)
+    return false;
+  at += 2 + 2 * keyCount;
+  return at <= end;
+}
+
+/* Walk the mode record at `at`, checking that it is well-formed and lies
+   within the first `end` bytes of the image. If entry is given, the offset of
+   each field is stored in it. */
+bool walkModeRecord(uint16_t at, uint16_t end, modeCacheEntry *entry) {
+  if (entry) entry->name = at;
+  if (!skipLabel(at, end))
+    return false;
+
+  if (entry) entry->wheelName = at;
+  if (!skipLabel(at, end))
+    return false;
+
+  for (uint8_t slot = 0; slot < NUMBER_OF_ACTION_SLOTS; slot++) {
+    if (entry) entry->actions[slot] = at;
+    if (!skipAction(at, end))
+      return false;
+  }
+
+  if (entry) entry->curve = at;
+  if (at >= end)
+    return false;
+  uint8_t pointCount = imageByte(at);
+  if (pointCount > ACCEL_CURVE_POINTS)
+    return false;
+  return at + 1 + 4 * pointCount <= end;
+}
+
+/* Check the image in the slot at `base`, which imageByte() then reads from.
+   Returns its number of modes, or 0 if it isn't a valid image. */
+uint8_t checkModeImage(uint16_t base) {
+  modeImageBase = base;
+  if ((imageByte(0) != 'S') || (imageByte(1) != 'W') || (imageByte(2) != MODE_IMAGE_VERSION))
+    return 0;
+
+  uint8_t count = imageByte(3);
+  uint16_t length = imageWord(4);
+  uint16_t tableEnd = MODE_IMAGE_HEADER_SIZE + 2 * count;
+  if ((count == 0) || (length < tableEnd) || (length > MODE_IMAGE_CAPACITY)) {
+    debugfln("Mode image: bad header");
+    return 0;
+  }
+
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = MODE_IMAGE_HEADER_SIZE; i < length; i++) {
+    crc = _crc16_update(crc, imageByte(i));
+  }
+  if (crc != imageWord(6)) {
+    debugfln("Mode image: bad CRC");
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint16_t offset = imageWord(MODE_IMAGE_HEADER_SIZE + 2 * i);
+    if ((offset < tableEnd) || !walkModeRecord(offset, length, NULL)) {
+      debugf("Mode image: bad mode ");
+      debugln(i);
+      return 0;
+    }
+  }
+  return count;
+}
+
+/* Use the mode image in the slot the slot byte points to if it is valid,
+   otherwise fall back to the built-in modes. Returns whether the image is in
+   use. */
+bool loadModeImage() {
+  clearModeCache();
+  storedModeCount = 0;
+  numberOfModes = FLASH_MODE_COUNT;
+  modeImageSlot = NO_MODE_IMAGE_SLOT;
+  modeListChanged = true;
+
+  uint8_t slot = eeprom_read_byte((const uint8_t *)MODE_IMAGE_ADDRESS);
+  if (slot >= MODE_IMAGE_SLOTS)
+    return false;
+
+  uint8_t count = checkModeImage(modeImageSlotAddress(slot));
+  if (count == 0)
+    return false;
+
+  storedModeCount = count;
+  modeImageLength = imageWord(4);
+  modeImageSlot = slot;
+  numberOfModes = count;
+  debugf("Mode image: ");
+  debug(count);
+  debugfln(" modes");
+  return true;
+}
+
+// to be called from inside main setup()
+void modeStorageSetup() {
+  loadModeImage();
+}
+
+// The cached field offsets of a mode in the image, looked up if needed
+const modeCacheEntry &cachedMode(uint8_t modeIndex) {
+  modeCacheClock++;
+
+  for (uint8_t i = 0; i < MODE_CACHE_SIZE; i++) {
+    if (modeCache[i].modeIndex == modeIndex) {
+      modeCache[i].lastUsed = modeCacheClock;
+      return modeCache[i];
+    }
+  }
+
+  // replace an unused entry or else the least recently used one
+  uint8_t replace = 0;
+  for (uint8_t i = 0; i < MODE_CACHE_SIZE; i++) {
+    if (modeCache[i].modeIndex == NO_CACHED_MODE) {
+      replace = i;
+      break;
+    }
+    if ((uint16_t)(modeCacheClock - modeCache[i].lastUsed) > (uint16_t)(modeCacheClock - modeCache[replace].lastUsed))
+      replace = i;
+  }
+
+  modeCacheEntry &entry = modeCache[replace];
+  walkModeRecord(imageWord(MODE_IMAGE_HEADER_SIZE + 2 * modeIndex), modeImageLength, &entry);
+  entry.modeIndex = modeIndex;
+  entry.lastUsed = modeCacheClock;
+  return entry;
+}
+
+// copy a label out of the image into dest, which must hold MAX_LABEL_LENGTH chars
+char *loadImageLabel(char *dest, uint16_t at) {
+  uint8_t length = imageByte(at);
+  eeprom_read_block(dest, (const void *)(modeImageBase + at + 1), length);
+  dest[length] = '\0';
+  return dest;
+}
+
+/* Accessors for the current mode list, from EEPROM or the flash-resident
+   controlModeList. Each one copies only the field asked for into RAM; never
+   copy a whole controlMode. */
+
+const controlAction *actionInFlash(uint8_t modeIndex, actionSlot slot) {
+  const controlMode *mode = &controlModeList[modeIndex];
+  switch (slot) {
+  case LEFT_ACTION:
+    return &mode->left;
+  case RIGHT_ACTION:
+    return &mode->right;
+  case MIDDLE_ACTION:
+    return &mode->middle;
+  case WHEEL_CW_ACTION:
+    return &mode->wheelCW;
+  case WHEEL_CCW_ACTION:
+    return &mode->wheelCCW;
+  case WHEEL_CW_ACCEL_ACTION:
+    return &mode->wheelCWAccel;
+  default:
+    return &mode->wheelCCWAccel;
+  }
+}
+
+// copy a label of the built-in modes out of modeLabels into dest
+char *loadFlashLabel(char *dest, const modeLabel *label) {
+  return strcpy_P(dest, modeLabels + pgm_read_word(&label->offset));
+}
+
+// copy the name of a mode into dest, which must hold MAX_LABEL_LENGTH chars
+char *loadModeName(char *dest, uint8_t modeIndex) {
+  if (storedModeCount)
+    return loadImageLabel(dest, cachedMode(modeIndex).name);
+  return loadFlashLabel(dest, &controlModeList[modeIndex].name);
+}
+
+// copy the scroll-wheel name of a mode into dest
+char *loadWheelName(char *dest, uint8_t modeIndex) {
+  if (storedModeCount)
+    return loadImageLabel(dest, cachedMode(modeIndex).wheelName);
+  return loadFlashLabel(dest, &controlModeList[modeIndex].wheelName);
+}
+
+// copy the name of one action of a mode into dest
+char *loadActionName(char *dest, uint8_t modeIndex, actionSlot slot) {
+  if (storedModeCount)
+    return loadImageLabel(dest, cachedMode(modeIndex).actions[slot]);
+  return loadFlashLabel(dest, &actionInFlash(modeIndex, slot)->name);
+}
+
+/* copy the keys and modeMask of one action of a mode into RAM; its name is
+   left out, see loadActionName() */
+controlAction loadAction(uint8_t modeIndex, actionSlot slot) {
+  controlAction action;
+  if (!storedModeCount) {
+    memcpy_P(&action, actionInFlash(modeIndex, slot), sizeof(controlAction));
+    return action;
+  }
+
+  uint16_t at = cachedMode(modeIndex).actions[slot];
+  at += 1 + imageByte(at); // the name
+  action.modeMask = imageByte(at);
+  uint8_t keyCount = imageByte(at + 1);
+  for (uint8_t i = 0; i < MAX_KEYS_PER_ACTION; i++) {
+    action.keys[i] = actionKeypress((i < keyCount) ? imageWord(at + 2 + 2 * i) : 0);
+  }
+  return action;
+}
+
+// does this action have at least one key attached?
+bool actionIsBound(uint8_t modeIndex, actionSlot slot) {
+  if (storedModeCount) {
+    uint16_t at = cachedMode(modeIndex).actions[slot];
+    at += 1 + imageByte(at);
+    return (imageByte(at + 1) > 0) && (imageWord(at + 2) != 0);
+  }
+  return pgm_read_word(&actionInFlash(modeIndex, slot)->keys[0].packed) != 0;
+}
+
+// copy point `i` of the acceleration curve of a mode; false past its end
+bool loadCurvePoint(uint8_t modeIndex, uint8_t i, accelCurvePoint &point) {
+  if (storedModeCount) {
+    uint16_t at = cachedMode(modeIndex).curve;
+    if (i >= imageByte(at))
+      return false;
+    point.detentsPerSecond = imageWord(at + 1 + 4 * i);
+    point.percent = imageWord(at + 3 + 4 * i);
+    return true;
+  }
+
+  if (i >= ACCEL_CURVE_POINTS)
+    return false;
+  const accelCurve *curve = &accelCurves[pgm_read_byte(&controlModeList[modeIndex].accelCurve)];
+  point.detentsPerSecond = pgm_read_word(&curve->points[i].detentsPerSecond);
+  point.percent = pgm_read_word(&curve->points[i].percent);
+  return true;
+}
+
+/* Percentage to scale wheel detents by at the given wheel speed, from the
+   acceleration curve of the mode */
+uint16_t accelPercent(uint8_t modeIndex, uint16_t velocity) {
+  accelCurvePoint low, high;
+  if (!loadCurvePoint(modeIndex, 0, low))
+    return 100;
+  if (velocity <= low.detentsPerSecond)
+    return low.percent;
+
+  for (uint8_t i = 1; loadCurvePoint(modeIndex, i, high); i++) {
+    if (high.detentsPerSecond <= low.detentsPerSecond)
+      break; // end of the curve
+
+    if (velocity < high.detentsPerSecond) {
+      return low.percent + (((long)high.percent - low.percent) * (velocity - low.detentsPerSecond)) / (high.detentsPerSecond - low.detentsPerSecond);
+    }
+    low = high;
+  }
+  return low.percent;
+}
+
+#ifdef ENABLE_MODE_UPLOAD
+/* Receiving a new image over the serial port, into the slot not in use. One
+   byte is written per call to modeUploadPoll(), and only once the previous
+   EEPROM write has finished, so the upload never blocks the main loop. The
+   image in use, if any, is kept until the new one has arrived whole, matches
+   the CRC it was announced with and passes checkModeImage(). */
+
+// give up on an upload if no byte arrives for this long; milliseconds
+#define MODE_UPLOAD_TIMEOUT 1000
+
+bool modeUploadInProgress = false;
+uint16_t modeUploadLength = 0;
+uint16_t modeUploadPosition = 0;
+uint16_t modeUploadCrc = 0; // as announced
+uint16_t modeUploadRunningCrc = 0; // of the bytes so far
+uint8_t modeUploadSlot = 0;
+unsigned long modeUploadLastByte = 0; // millis()
+
+/* Start receiving an image of `length` bytes whose CRC-16 (as in the image
+   header, but over the whole image) is `crc` */
+void beginModeUpload(uint16_t length, uint16_t crc) {
+  if ((length < MODE_IMAGE_HEADER_SIZE) || (length > MODE_IMAGE_CAPACITY)) {
+    Serial.println(F("ERR length"));
+    return;
+  }
+
+  modeUploadInProgress = true;
+  modeUploadLength = length;
+  modeUploadPosition = 0;
+  modeUploadCrc = crc;
+  modeUploadRunningCrc = 0xFFFF;
+  modeUploadSlot = (modeImageSlot == 0) ? 1 : 0;
+  modeUploadLastByte = millis();
+}
+
+void modeUploadPoll() {
+  if (millis() - modeUploadLastByte > MODE_UPLOAD_TIMEOUT) {
+    modeUploadInProgress = false;
+    Serial.println(F("ERR timeout"));
+    return;
+  }
+
+  if (!eeprom_is_ready() || !Serial.available())
+    return;
+
+  uint8_t value = Serial.read();
+  modeUploadLastByte = millis();
+  modeUploadRunningCrc = _crc16_update(modeUploadRunningCrc, value);
+  eeprom_update_byte((uint8_t *)(modeImageSlotAddress(modeUploadSlot) + modeUploadPosition), value);
+
+  if (++modeUploadPosition < modeUploadLength)
+    return;
+
+  modeUploadInProgress = false;
+  if (modeUploadRunningCrc != modeUploadCrc) {
+    Serial.println(F("ERR CRC"));
+    return;
+  }
+
+  uint16_t base = modeImageBase;
+  bool valid = checkModeImage(modeImageSlotAddress(modeUploadSlot)) > 0;
+  modeImageBase = base;
+  if (!valid) {
+    Serial.println(F("ERR invalid image"));
+    return;
+  }
+
+  eeprom_update_byte((uint8_t *)MODE_IMAGE_ADDRESS, modeUploadSlot);
+  loadModeImage();
+  Serial.print(F("OK "));
+  Serial.println(storedModeCount);
+}
+
+// Go back to the built-in modes
+void eraseModeImage() {
+  eeprom_update_byte((uint8_t *)MODE_IMAGE_ADDRESS, NO_MODE_IMAGE_SLOT);
+  loadModeImage();
+  Serial.println(F("OK 0"));
+}
+#endif
+
+#endif
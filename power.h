@@ -0,0 +1,85 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "config.h"
+#include "instrumentation.h"
+#include "encoder.h"
+
+/*
+Idle sleep. When loop() has nothing left to do, the MCU sleeps until the next
+interrupt instead of spinning. Idle is the deepest sleep mode that keeps USB
+and the millis() timer running, so the controller stays enumerated and button
+debouncing keeps its timing.
+
+The CPU is woken by:
+  * the millis() timer, about once every millisecond
+  * USB
+  * the encoder's pin-change interrupt
+  * a change on any button pin that has a pin-change or external interrupt.
+    On the 32u4 that is UP (PCINT6) and MIDDLE (INT6); the other buttons have
+    no interrupt and are seen at the next timer wake, at most ~1ms later.
+
+With ENABLE_INSTRUMENTATION the time from waking to the first HID report is
+recorded (WAKE_LATENCY_STAT).
+*/
+
+#ifndef HOST_SIMULATION
+#include <avr/sleep.h>
+#include <avr/power.h>
+
+// interrupts only need to wake the CPU; the buttons are read in loop()
+void wakeFromSleep() {
+}
+
+void enableWakeOnPin(uint8_t pin) {
+  if (digitalPinToInterrupt(pin) != NOT_AN_INTERRUPT) {
+    attachInterrupt(digitalPinToInterrupt(pin), wakeFromSleep, CHANGE);
+  } else if (digitalPinToPCICR(pin)) {
+    // shares PCINT0_vect with the encoder, which ignores pins that aren't its own
+    *digitalPinToPCICR(pin) |= (1 << digitalPinToPCICRbit(pin));
+    *digitalPinToPCMSK(pin) |= (1 << digitalPinToPCMSKbit(pin));
+  }
+}
+#endif
+
+// to be called from inside main setup(), after buttonsSetup() and encoderSetup()
+void powerSetup() {
+  #ifndef HOST_SIMULATION
+    // peripherals that are never used
+    ADCSRA = 0;
+    power_adc_disable();
+    power_spi_disable();
+    power_usart1_disable();
+
+    #ifdef ENABLE_IDLE_SLEEP
+      enableWakeOnPin(MIDDLE_PIN);
+      enableWakeOnPin(UP_PIN);
+      enableWakeOnPin(DOWN_PIN);
+      enableWakeOnPin(LEFT_PIN);
+      enableWakeOnPin(RIGHT_PIN);
+    #endif
+  #endif
+}
+
+/* Sleep until the next interrupt; to be called at the end of loop() when
+   there is no pending work. Returns straight away if a wheel detent is
+   already queued. */
+void idleSleep() {
+  #if defined(ENABLE_IDLE_SLEEP) && !defined(HOST_SIMULATION)
+    set_sleep_mode(SLEEP_MODE_IDLE);
+
+    noInterrupts();
+    if (encoderQueueHead != encoderQueueTail) {
+      interrupts();
+      return;
+    }
+    sleep_enable();
+    interrupts(); // takes effect after the next instruction, so a wake-up can't be missed
+    sleep_cpu();
+    sleep_disable();
+
+    instrumentWake();
+  #endif
+}
+
+#endif
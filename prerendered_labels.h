@@ -0,0 +1,269 @@
+// Generated by tools/prerender_labels.py; do not edit
+#ifndef PRERENDERED_LABELS_H
+#define PRERENDERED_LABELS_H
+
+#include "fonts/font8x8_custom.h"
+
+// font8x8_custom, " Bright "
+const char prerenderedText0[] PROGMEM = " Bright ";
+const uint8_t prerenderedBitmap0[] PROGMEM = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x4A, 0x4A, 0x4A, 0x4A, 0x34, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x7A, 0x40, 0x00, 0x00, 0x00, 0x18, 0xA4, 0xA4, 0xA4, 0xA4, 0x7C, 0x00, 0x00, 0x7E, 0x08, 0x08, 0x08, 0x70, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, " Scroll "
+const char prerenderedText1[] PROGMEM = " Scroll ";
+const uint8_t prerenderedBitmap1[] PROGMEM = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, " Scrub "
+const char prerenderedText2[] PROGMEM = " Scrub ";
+const uint8_t prerenderedBitmap2[] PROGMEM = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7E, 0x48, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, " Volume "
+const char prerenderedText3[] PROGMEM = " Volume ";
+const uint8_t prerenderedBitmap3[] PROGMEM = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "+"
+const char prerenderedText4[] PROGMEM = "+";
+const uint8_t prerenderedBitmap4[] PROGMEM = {
+  0x00, 0x10, 0x10, 0x7C, 0x10, 0x10, 0x00, 0x00,
+};
+// font8x8_custom, "-"
+const char prerenderedText5[] PROGMEM = "-";
+const uint8_t prerenderedBitmap5[] PROGMEM = {
+  0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00,
+};
+// font8x8_custom, "- Bright +"
+const char prerenderedText6[] PROGMEM = "- Bright +";
+const uint8_t prerenderedBitmap6[] PROGMEM = {
+  0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x4A, 0x4A, 0x4A, 0x4A, 0x34, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x7A, 0x40, 0x00, 0x00, 0x00, 0x18, 0xA4, 0xA4, 0xA4, 0xA4, 0x7C, 0x00, 0x00, 0x7E, 0x08, 0x08, 0x08, 0x70, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x7C, 0x10, 0x10, 0x00, 0x00,
+};
+// font8x8_custom, "- Volume +"
+const char prerenderedText7[] PROGMEM = "- Volume +";
+const uint8_t prerenderedBitmap7[] PROGMEM = {
+  0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x7C, 0x10, 0x10, 0x00, 0x00,
+};
+// font8x8_custom, "--"
+const char prerenderedText8[] PROGMEM = "--";
+const uint8_t prerenderedBitmap8[] PROGMEM = {
+  0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00,
+};
+// font8x8_custom, "< Scrub >"
+const char prerenderedText9[] PROGMEM = "< Scrub >";
+const uint8_t prerenderedBitmap9[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7E, 0x48, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "<- Media"
+const char prerenderedText10[] PROGMEM = "<- Media";
+const uint8_t prerenderedBitmap10[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x30, 0x48, 0x48, 0x48, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x7A, 0x40, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00,
+};
+// font8x8_custom, "<- Mouse"
+const char prerenderedText11[] PROGMEM = "<- Mouse";
+const uint8_t prerenderedBitmap11[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "<- System"
+const char prerenderedText12[] PROGMEM = "<- System";
+const uint8_t prerenderedBitmap12[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00,
+};
+// font8x8_custom, "<- VLC"
+const char prerenderedText13[] PROGMEM = "<- VLC";
+const uint8_t prerenderedBitmap13[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x7E, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x3C, 0x42, 0x42, 0x42, 0x42, 0x24, 0x00, 0x00,
+};
+// font8x8_custom, "<- Volume"
+const char prerenderedText14[] PROGMEM = "<- Volume";
+const uint8_t prerenderedBitmap14[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "<- YouTube"
+const char prerenderedText15[] PROGMEM = "<- YouTube";
+const uint8_t prerenderedBitmap15[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x04, 0x08, 0x70, 0x08, 0x04, 0x02, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x02, 0x02, 0x02, 0x7E, 0x02, 0x02, 0x02, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7E, 0x48, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "<<"
+const char prerenderedText16[] PROGMEM = "<<";
+const uint8_t prerenderedBitmap16[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "<< Scrub >>"
+const char prerenderedText17[] PROGMEM = "<< Scrub >>";
+const uint8_t prerenderedBitmap17[] PROGMEM = {
+  0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7E, 0x48, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, ">>"
+const char prerenderedText18[] PROGMEM = ">>";
+const uint8_t prerenderedBitmap18[] PROGMEM = {
+  0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "Btn"
+const char prerenderedText19[] PROGMEM = "Btn";
+const uint8_t prerenderedBitmap19[] PROGMEM = {
+  0x7E, 0x4A, 0x4A, 0x4A, 0x4A, 0x34, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x04, 0x04, 0x78, 0x00, 0x00,
+};
+// font8x8_custom, "Ext"
+const char prerenderedText20[] PROGMEM = "Ext";
+const uint8_t prerenderedBitmap20[] PROGMEM = {
+  0x7E, 0x4A, 0x4A, 0x4A, 0x4A, 0x42, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00,
+};
+// font8x8_custom, "Left"
+const char prerenderedText21[] PROGMEM = "Left";
+const uint8_t prerenderedBitmap21[] PROGMEM = {
+  0x7E, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7C, 0x0A, 0x02, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00,
+};
+// font8x8_custom, "Media"
+const char prerenderedText22[] PROGMEM = "Media";
+const uint8_t prerenderedBitmap22[] PROGMEM = {
+  0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x30, 0x48, 0x48, 0x48, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x7A, 0x40, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00,
+};
+// font8x8_custom, "Media ->"
+const char prerenderedText23[] PROGMEM = "Media ->";
+const uint8_t prerenderedBitmap23[] PROGMEM = {
+  0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x30, 0x48, 0x48, 0x48, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x7A, 0x40, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "Mid"
+const char prerenderedText24[] PROGMEM = "Mid";
+const uint8_t prerenderedBitmap24[] PROGMEM = {
+  0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x7A, 0x40, 0x00, 0x00, 0x00, 0x30, 0x48, 0x48, 0x48, 0x7E, 0x00, 0x00,
+};
+// font8x8_custom, "Mouse"
+const char prerenderedText25[] PROGMEM = "Mouse";
+const uint8_t prerenderedBitmap25[] PROGMEM = {
+  0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "Mouse ->"
+const char prerenderedText26[] PROGMEM = "Mouse ->";
+const uint8_t prerenderedBitmap26[] PROGMEM = {
+  0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "Mute"
+const char prerenderedText27[] PROGMEM = "Mute";
+const uint8_t prerenderedBitmap27[] PROGMEM = {
+  0x7E, 0x04, 0x08, 0x08, 0x04, 0x7E, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "Next"
+const char prerenderedText28[] PROGMEM = "Next";
+const uint8_t prerenderedBitmap28[] PROGMEM = {
+  0x7E, 0x04, 0x08, 0x10, 0x20, 0x7E, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00,
+};
+// font8x8_custom, "Pause"
+const char prerenderedText29[] PROGMEM = "Pause";
+const uint8_t prerenderedBitmap29[] PROGMEM = {
+  0x7E, 0x12, 0x12, 0x12, 0x12, 0x0C, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "Play"
+const char prerenderedText30[] PROGMEM = "Play";
+const uint8_t prerenderedBitmap30[] PROGMEM = {
+  0x7E, 0x12, 0x12, 0x12, 0x12, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x20, 0x54, 0x54, 0x54, 0x78, 0x00, 0x00, 0x00, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C, 0x00, 0x00,
+};
+// font8x8_custom, "Prev"
+const char prerenderedText31[] PROGMEM = "Prev";
+const uint8_t prerenderedBitmap31[] PROGMEM = {
+  0x7E, 0x12, 0x12, 0x12, 0x12, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x0C, 0x30, 0x40, 0x30, 0x0C, 0x00, 0x00,
+};
+// font8x8_custom, "Right"
+const char prerenderedText32[] PROGMEM = "Right";
+const uint8_t prerenderedBitmap32[] PROGMEM = {
+  0x7E, 0x12, 0x12, 0x12, 0x32, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x7A, 0x40, 0x00, 0x00, 0x00, 0x18, 0xA4, 0xA4, 0xA4, 0xA4, 0x7C, 0x00, 0x00, 0x7E, 0x08, 0x08, 0x08, 0x70, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00,
+};
+// font8x8_custom, "Seek"
+const char prerenderedText33[] PROGMEM = "Seek";
+const uint8_t prerenderedBitmap33[] PROGMEM = {
+  0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x7E, 0x18, 0x24, 0x40, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "System"
+const char prerenderedText34[] PROGMEM = "System";
+const uint8_t prerenderedBitmap34[] PROGMEM = {
+  0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00,
+};
+// font8x8_custom, "System ->"
+const char prerenderedText35[] PROGMEM = "System ->";
+const uint8_t prerenderedBitmap35[] PROGMEM = {
+  0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x54, 0x20, 0x00, 0x00, 0x00, 0x00, 0x04, 0x3E, 0x44, 0x40, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "VLC"
+const char prerenderedText36[] PROGMEM = "VLC";
+const uint8_t prerenderedBitmap36[] PROGMEM = {
+  0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x7E, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x3C, 0x42, 0x42, 0x42, 0x42, 0x24, 0x00, 0x00,
+};
+// font8x8_custom, "VLC ->"
+const char prerenderedText37[] PROGMEM = "VLC ->";
+const uint8_t prerenderedBitmap37[] PROGMEM = {
+  0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x7E, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x3C, 0x42, 0x42, 0x42, 0x42, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "Volume"
+const char prerenderedText38[] PROGMEM = "Volume";
+const uint8_t prerenderedBitmap38[] PROGMEM = {
+  0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "Volume ->"
+const char prerenderedText39[] PROGMEM = "Volume ->";
+const uint8_t prerenderedBitmap39[] PROGMEM = {
+  0x1E, 0x20, 0x40, 0x40, 0x20, 0x1E, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7C, 0x04, 0x78, 0x04, 0x78, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "YouTube"
+const char prerenderedText40[] PROGMEM = "YouTube";
+const uint8_t prerenderedBitmap40[] PROGMEM = {
+  0x02, 0x04, 0x08, 0x70, 0x08, 0x04, 0x02, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x02, 0x02, 0x02, 0x7E, 0x02, 0x02, 0x02, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7E, 0x48, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00,
+};
+// font8x8_custom, "YouTube ->"
+const char prerenderedText41[] PROGMEM = "YouTube ->";
+const uint8_t prerenderedBitmap41[] PROGMEM = {
+  0x02, 0x04, 0x08, 0x70, 0x08, 0x04, 0x02, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x02, 0x02, 0x02, 0x7E, 0x02, 0x02, 0x02, 0x00, 0x00, 0x3C, 0x40, 0x40, 0x40, 0x3C, 0x00, 0x00, 0x00, 0x7E, 0x48, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x38, 0x54, 0x54, 0x54, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x44, 0x28, 0x10, 0x00, 0x00, 0x00,
+};
+// font8x8_custom, "^ Scroll _"
+const char prerenderedText42[] PROGMEM = "^ Scroll _";
+const uint8_t prerenderedBitmap42[] PROGMEM = {
+  0x00, 0x08, 0x04, 0x7E, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x4A, 0x4A, 0x4A, 0x4A, 0x30, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x00, 0x00, 0x00, 0x00, 0x78, 0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x20, 0x7E, 0x20, 0x10, 0x00, 0x00,
+};
+
+const prerenderedLabel prerenderedLabels[] PROGMEM = {
+  {font8x8_custom, prerenderedText0, prerenderedBitmap0, 8, 64},
+  {font8x8_custom, prerenderedText1, prerenderedBitmap1, 8, 64},
+  {font8x8_custom, prerenderedText2, prerenderedBitmap2, 7, 56},
+  {font8x8_custom, prerenderedText3, prerenderedBitmap3, 8, 64},
+  {font8x8_custom, prerenderedText4, prerenderedBitmap4, 1, 8},
+  {font8x8_custom, prerenderedText5, prerenderedBitmap5, 1, 8},
+  {font8x8_custom, prerenderedText6, prerenderedBitmap6, 10, 80},
+  {font8x8_custom, prerenderedText7, prerenderedBitmap7, 10, 80},
+  {font8x8_custom, prerenderedText8, prerenderedBitmap8, 2, 16},
+  {font8x8_custom, prerenderedText9, prerenderedBitmap9, 9, 72},
+  {font8x8_custom, prerenderedText10, prerenderedBitmap10, 8, 64},
+  {font8x8_custom, prerenderedText11, prerenderedBitmap11, 8, 64},
+  {font8x8_custom, prerenderedText12, prerenderedBitmap12, 9, 72},
+  {font8x8_custom, prerenderedText13, prerenderedBitmap13, 6, 48},
+  {font8x8_custom, prerenderedText14, prerenderedBitmap14, 9, 72},
+  {font8x8_custom, prerenderedText15, prerenderedBitmap15, 10, 80},
+  {font8x8_custom, prerenderedText16, prerenderedBitmap16, 2, 16},
+  {font8x8_custom, prerenderedText17, prerenderedBitmap17, 11, 88},
+  {font8x8_custom, prerenderedText18, prerenderedBitmap18, 2, 16},
+  {font8x8_custom, prerenderedText19, prerenderedBitmap19, 3, 24},
+  {font8x8_custom, prerenderedText20, prerenderedBitmap20, 3, 24},
+  {font8x8_custom, prerenderedText21, prerenderedBitmap21, 4, 32},
+  {font8x8_custom, prerenderedText22, prerenderedBitmap22, 5, 40},
+  {font8x8_custom, prerenderedText23, prerenderedBitmap23, 8, 64},
+  {font8x8_custom, prerenderedText24, prerenderedBitmap24, 3, 24},
+  {font8x8_custom, prerenderedText25, prerenderedBitmap25, 5, 40},
+  {font8x8_custom, prerenderedText26, prerenderedBitmap26, 8, 64},
+  {font8x8_custom, prerenderedText27, prerenderedBitmap27, 4, 32},
+  {font8x8_custom, prerenderedText28, prerenderedBitmap28, 4, 32},
+  {font8x8_custom, prerenderedText29, prerenderedBitmap29, 5, 40},
+  {font8x8_custom, prerenderedText30, prerenderedBitmap30, 4, 32},
+  {font8x8_custom, prerenderedText31, prerenderedBitmap31, 4, 32},
+  {font8x8_custom, prerenderedText32, prerenderedBitmap32, 5, 40},
+  {font8x8_custom, prerenderedText33, prerenderedBitmap33, 4, 32},
+  {font8x8_custom, prerenderedText34, prerenderedBitmap34, 6, 48},
+  {font8x8_custom, prerenderedText35, prerenderedBitmap35, 9, 72},
+  {font8x8_custom, prerenderedText36, prerenderedBitmap36, 3, 24},
+  {font8x8_custom, prerenderedText37, prerenderedBitmap37, 6, 48},
+  {font8x8_custom, prerenderedText38, prerenderedBitmap38, 6, 48},
+  {font8x8_custom, prerenderedText39, prerenderedBitmap39, 9, 72},
+  {font8x8_custom, prerenderedText40, prerenderedBitmap40, 7, 56},
+  {font8x8_custom, prerenderedText41, prerenderedBitmap41, 10, 80},
+  {font8x8_custom, prerenderedText42, prerenderedBitmap42, 10, 80},
+};
+
+#endif
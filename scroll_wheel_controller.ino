@@ -13,7 +13,6 @@ Hardware:
 Required libraries:
   * Arduino HID Project: https://github.com/NicoHood/HID/
   * SSD1306: https://github.com/greiman/SSD1306Ascii
-  * Rotary: https://github.com/brianlow/Rotary
 
 */
 
@@ -25,11 +24,18 @@ Required libraries:
 #include "config.h" // General global configuration
 #include "layouts.h" // Set the font to use and label position on display
 #include "control_modes.h" // Set the different control modes (keypres actions)
+#include "mode_storage.h" // Control modes uploaded to EEPROM
+#include "hid_output.h"
+#include "macros.h"
 #include "buttons.h"
+#include "gestures.h"
 #include "encoder.h"
+#include "power.h"
 #include "debugging.h"
-
-const uint8_t numberOfModes = sizeof (controlModeList) / sizeof (controlModeList[0]);
+#include "instrumentation.h"
+#include "host_control.h"
+#include "serial_commands.h"
+#include "trace.h"
 
 uint8_t currentModeIndex = (DEFAULT_MODE > (numberOfModes - 1)) ? 0 : DEFAULT_MODE;
 
@@ -43,6 +49,7 @@ unsigned long lastAction = 0;
 
 // Screensaver state
 bool screensaverEnabled = false;
+unsigned long screensaverStarted = 0; // millis()
 const char screensaverText[] = SCREENSAVER_TEXT;
 
 /* If ENABLE_DEBUGGING is on, this keeps track of the last time the current
@@ -50,86 +57,148 @@ const char screensaverText[] = SCREENSAVER_TEXT;
    is also the last time the the screensaver text was moved. Milliseconds */
 unsigned long nextOutput = OUTPUT_EVERY;
 
-boolean keyboardPressed = false; // is Keyboard in currently-pressed state?
-boolean consumerPressed = false; // is Consumer in currently-pressed state?
-
-uint8_t clickAccelCount = 0;
-unsigned long nextClickAccelCheck = CLICK_ACCEL_EVERY;
-
-controlMode currentMode() {
-  return controlModeList[currentModeIndex];
-}
-
-controlMode toggleMode() {
-  return controlModeList[toggleModeIndex];
+/* Wheel actions are released on a deadline rather than by blocking in delay(),
+   so buttons and the encoder keep being serviced while keys are held down.
+   Since releasing is always a releaseAll(), only the one outstanding deadline
+   needs to be tracked. Milliseconds */
+bool releaseScheduled = false;
+bool scheduledReleaseIsLong = false;
+unsigned long scheduledReleaseAt = 0;
+
+/* Wheel detents taken off the encoder queue but not sent yet (only ever more
+   than one for long keypress actions); negative is CCW */
+int8_t wheelDetentsPending = 0;
+unsigned long wheelDetentsPendingSince = 0; // micros() of the oldest pending detent
+
+/* Fraction of a detent (in percent) left over after the acceleration curve
+   was applied to the last batch of detents, carried into the next batch */
+uint8_t accelCarry = 0;
+
+controlAction currentAction(actionSlot slot) {
+  return loadAction(currentModeIndex, slot);
 }
 
-controlMode previousMode() {
-  return controlModeList[previousModeIndex];
+// The separately-redrawn areas of the display, see renderDisplayFields()
+#define MODE_NAME_FIELD 0
+#define MIDDLE_FIELD 1
+#define LEFT_FIELD 2
+#define RIGHT_FIELD 3
+#define WHEEL_FIELD 4
+#define QUICK_TOGGLE_FIELD 5
+#define NUMBER_OF_FIELDS 6
+
+displayField displayFields[NUMBER_OF_FIELDS] = {
+  {"", 0, ALIGN_CENTER},
+  {"", 0, ALIGN_CENTER},
+  {"", 0, ALIGN_LEFT},
+  {"", 0, ALIGN_RIGHT},
+  {"", 0, ALIGN_CENTER},
+  {"", 0, ALIGN_CENTER},
+};
+
+/* The state the display fields were last built from. While none of it
+   changes, the texts and their layout in displayFields stay valid and a
+   redraw is just printing them again. */
+bool displayFieldsBuilt = false;
+uint8_t displayedModeIndex;
+uint8_t displayedPreviousModeIndex;
+uint8_t displayedToggleModeIndex;
+uint8_t displayedLayoutIndex;
+bool displayedAccelerated;
+uint8_t displayedTransientLabelVersion;
+
+bool displayFieldsCurrent() {
+  return displayFieldsBuilt
+    && (displayedModeIndex == currentModeIndex)
+    && (displayedPreviousModeIndex == previousModeIndex)
+    && (displayedToggleModeIndex == toggleModeIndex)
+    && (displayedLayoutIndex == currentLayoutIndex)
+    && (displayedAccelerated == isAccelerated)
+    && (displayedTransientLabelVersion == transientLabelVersion);
 }
 
-// Update the connected oled display
+/* Update the connected oled display. Only the fields whose text changed since
+   the last update are redrawn; call invalidateDisplay() first to force a full
+   redraw. This only queues the drawing, which loop() then does a little at a
+   time through serviceDisplay(). */
 void updateDisplay() {
-  oled.clear();
+  instrumentMicrosStart(displayStart);
 
-  oledPrintCentered(currentMode().name, 0);
-
-  // oled.setCursor(0, 1);
-  // oled.print("01234567890123456789012345678901234567890");
-
-  // middle button
-  if (strlen(currentMode().middle.name) > 0)
-    oledPrintCentered(currentMode().middle.name, currentLayout().middleButtonLabelRow);
+  if (displayFieldsCurrent()) {
+    redrawDisplayFields(displayFields, NUMBER_OF_FIELDS);
+    instrumentMicrosEnd(DISPLAY_UPDATE_STAT, displayStart);
+    return;
+  }
 
-  // left button
-  if (strlen(currentMode().left.name) > 0)
-    oledPrintLeftJustify(currentMode().left.name, currentLayout().leftRightButtonLabelRow);
+  char texts[NUMBER_OF_FIELDS][MAX_FIELD_LENGTH];
+  uint8_t rows[NUMBER_OF_FIELDS] = {
+    currentLayout().currentModeLabelRow,
+    currentLayout().middleButtonLabelRow,
+    currentLayout().leftRightButtonLabelRow,
+    currentLayout().leftRightButtonLabelRow,
+    currentLayout().wheelActionLabelRow,
+    currentLayout().quickToggleLabelRow
+  };
 
-  // right button
-  if (strlen(currentMode().right.name) > 0)
-    oledPrintRightJustify(currentMode().right.name, currentLayout().leftRightButtonLabelRow);
+  loadModeName(texts[MODE_NAME_FIELD], currentModeIndex);
 
-  // wheel actions
-  if (strlen(currentMode().wheelName) > 0) {
-    const char label[MAX_LABEL_LENGTH*2];
-    if (isAccelerated) {
-      strcpy(label, currentMode().wheelCWAccel.name);
-    } else {
-      strcpy(label, currentMode().wheelCW.name);
-    }
-    strcat(label, " ");
-    strcat(label, currentMode().wheelName);
-    strcat(label, " ");
-    if (isAccelerated) {
-      strcat(label, currentMode().wheelCCWAccel.name);
-    } else {
-      strcat(label, currentMode().wheelCCW.name);
-    }
+  // oled.setCursor(0, 1);
+  // oled.print("01234567890123456789012345678901234567890");
 
-    oledPrintCentered(label, currentLayout().wheelActionLabelRow);
+  loadActionName(texts[MIDDLE_FIELD], currentModeIndex, MIDDLE_ACTION);
+  loadActionName(texts[LEFT_FIELD], currentModeIndex, LEFT_ACTION);
+  loadActionName(texts[RIGHT_FIELD], currentModeIndex, RIGHT_ACTION);
+
+  // wheel actions, clamped to the field; tools/encode_modes.py rejects modes they don't fit
+  char *label = texts[WHEEL_FIELD];
+  char wheelName[MAX_LABEL_LENGTH];
+  if (strlen(loadWheelName(wheelName, currentModeIndex)) > 0) {
+    char actionName[MAX_LABEL_LENGTH];
+    loadActionName(actionName, currentModeIndex, isAccelerated ? WHEEL_CW_ACCEL_ACTION : WHEEL_CW_ACTION);
+    strlcpy(label, actionName, MAX_FIELD_LENGTH);
+    strlcat(label, " ", MAX_FIELD_LENGTH);
+    strlcat(label, wheelName, MAX_FIELD_LENGTH);
+    strlcat(label, " ", MAX_FIELD_LENGTH);
+    loadActionName(actionName, currentModeIndex, isAccelerated ? WHEEL_CCW_ACCEL_ACTION : WHEEL_CCW_ACTION);
+    strlcat(label, actionName, MAX_FIELD_LENGTH);
+  } else {
+    strcpy(label, "");
   }
 
-  // mode quick-toggle
-  const char quickToggleLabel[MAX_LABEL_LENGTH*2];
-  if (previousModeIndex == currentModeIndex) {
+  // mode quick-toggle, unless the host has something to say
+  char *quickToggleLabel = texts[QUICK_TOGGLE_FIELD];
+  char modeName[MAX_LABEL_LENGTH];
+  if (transientLabel[0] != '\0') {
+    strlcpy(quickToggleLabel, transientLabel, MAX_FIELD_LENGTH);
+  } else if (previousModeIndex == currentModeIndex) {
     if (currentModeIndex != toggleModeIndex) {
-      strcpy(quickToggleLabel, toggleMode().name);
-      strcat(quickToggleLabel, " ->");
+      strlcpy(quickToggleLabel, loadModeName(modeName, toggleModeIndex), MAX_FIELD_LENGTH);
+      strlcat(quickToggleLabel, " ->", MAX_FIELD_LENGTH);
 
     } else {
       strcpy(quickToggleLabel, "--");
     }
   } else {
     if (previousModeIndex != toggleModeIndex) {
-      strcpy(quickToggleLabel, "<- ");
-      strcat(quickToggleLabel, previousMode().name);
+      strlcpy(quickToggleLabel, "<- ", MAX_FIELD_LENGTH);
+      strlcat(quickToggleLabel, loadModeName(modeName, previousModeIndex), MAX_FIELD_LENGTH);
     } else {
-      strcpy(quickToggleLabel, toggleMode().name);
-      strcat(quickToggleLabel, " ->");
+      strlcpy(quickToggleLabel, loadModeName(modeName, toggleModeIndex), MAX_FIELD_LENGTH);
+      strlcat(quickToggleLabel, " ->", MAX_FIELD_LENGTH);
     }
   }
-  if (currentLayout().quickToggleLabelRow <= displayHeightInRows-1)
-    oledPrintCentered(quickToggleLabel, currentLayout().quickToggleLabelRow);
+
+  renderDisplayFields(displayFields, NUMBER_OF_FIELDS, texts, rows);
+
+  displayFieldsBuilt = true;
+  displayedModeIndex = currentModeIndex;
+  displayedPreviousModeIndex = previousModeIndex;
+  displayedToggleModeIndex = toggleModeIndex;
+  displayedLayoutIndex = currentLayoutIndex;
+  displayedAccelerated = isAccelerated;
+  displayedTransientLabelVersion = transientLabelVersion;
+
+  instrumentMicrosEnd(DISPLAY_UPDATE_STAT, displayStart);
 }
 
 /* Are we currently in quick-toggle mode? */
@@ -143,27 +212,46 @@ void updateLastAction() {
   lastAction = millis();
   if (screensaverEnabled) {
     screensaverEnabled = false;
+    if (displayAsleep)
+      sleepDisplay(false);
+    dimDisplay(false);
+    invalidateDisplay();
     updateDisplay();
   }
 }
 
+/* Start over from the default mode; to be called whenever the mode list is
+   replaced */
+void resetModes() {
+  modeListChanged = false;
+  currentModeIndex = (DEFAULT_MODE > (numberOfModes - 1)) ? 0 : DEFAULT_MODE;
+  previousModeIndex = currentModeIndex;
+  toggleModeIndex = 0;
+  displayFieldsBuilt = false;
+  trace(TRACE_MODE, currentModeIndex, previousModeIndex);
+}
+
 void setup() {
-  #ifdef ENABLE_DEBUGGING
+  #if defined(ENABLE_DEBUGGING) || defined(SERIAL_COMMANDS)
     Serial.begin(DEBUG_BAUD);
   #endif
 
   mcuSetup();
 
+  instrumentationSetup();
+
   displaySetup();
 
   layoutSetup();
 
   buttonsSetup();
 
+  modeStorageSetup();
+  resetModes();
+
   // Put this in main setup() to give you a chance to reprogram the MCU in case
   // things get wedged; just hold th middle button while booting and the MCU
   // Will enable the serial port and then just wait forever
-  middleButton.read();
   if (middleButton.isPressed()) {
     Serial.begin(DEBUG_BAUD);
     oled.clear();
@@ -189,100 +277,159 @@ void setup() {
   Mouse.begin();
 
   encoderSetup();
+
+  powerSetup();
+}
+
+// Release keys now if the scheduled release is still outstanding
+void flushScheduledRelease() {
+  if (releaseScheduled) {
+    debugfln("Flushing scheduled release");
+    releaseScheduled = false;
+    releaseKeys();
+  }
+}
+
+// Release keys if the scheduled release deadline has passed
+void serviceScheduledRelease(unsigned long currentMillis) {
+  if (releaseScheduled && ((long)(currentMillis - scheduledReleaseAt) >= 0)) {
+    debugfln("Scheduled release due");
+    releaseScheduled = false;
+    releaseKeys();
+  }
+}
+
+/* If this action does nothing but scroll the mouse wheel, how far it scrolls
+   per detent; otherwise 0. Several detents of such an action can be folded
+   into a single report. */
+uint16_t actionOnlyScrolls(const controlAction &action) {
+  uint16_t scrollAmount = 0;
+  for (uint8_t i = 0; i < MAX_KEYS_PER_ACTION; i++) {
+    if (action.keys[i].packed == 0)
+      continue;
+
+    if ((action.keys[i].hidType() != MOUSE_HID_TYPE) || !(action.keys[i].keyCode() & (0b01100000)))
+      return 0;
+
+    if (scrollAmount == 0)
+      scrollAmount = defaultScrollAmount(action.keys[i]);
+  }
+  return scrollAmount;
 }
 
-// Send action but don't release the keys
+/* Send action but don't release the keys. Its keyboard and consumer keys go
+   out together, in one report per device. Mouse wheel scrolls move by
+   scrollAmount (see stageKey()), so several wheel detents can go out as one
+   report. */
 
-void sendAction(controlAction actionToSend)
+void sendAction(const controlAction &actionToSend, uint16_t scrollAmount = DEFAULT_SCROLL_AMOUNT)
 {
+  // a new press always completes the previous one first
+  flushScheduledRelease();
+  stopMacro();
+
   setIndicatorLed(1);
   updateLastAction();
+  instrumentReport();
 
-  debugf("Sending key action '");
-  debug(actionToSend.name);
-  debugfln("'");
+  // the name isn't loaded with the action, so it is known by its first key
+  debugf("Sending key action ");
+  debuglnfmt(actionToSend.keys[0].packed, HEX);
   
   for (uint8_t i = 0; i < MAX_KEYS_PER_ACTION; i++) {
-    if (actionToSend.keys[i].keyCode != NULL) {
-
-      debugf("HID_TYPE: ");
-      debugfmt(actionToSend.keys[i].keyCode, HEX);
-
-      if (actionToSend.keys[i].hidType == CONSUMER_HID_TYPE) {
-        debugfln(" CONSUMER_HID_TYPE");
-
-        Consumer.press(actionToSend.keys[i].keyCode);
-        consumerPressed = true;
-      } else if (actionToSend.keys[i].hidType == MOUSE_HID_TYPE) {
-        debugfln(" MOUSE_HID_TYPE");
-
-        if (bitRead(actionToSend.keys[i].keyCode, 6)) {
-          debugfln("scrolling down");
-          Mouse.move(0, 0, MOUSE_SCROLL_AMOUNT);
-        } else if (bitRead(actionToSend.keys[i].keyCode, 5)) {
-          debugfln("scrolling up");
-          Mouse.move(0, 0, -MOUSE_SCROLL_AMOUNT);
-        } else if (bitRead(actionToSend.keys[i].keyCode, 4)) {
-          debugfln("left click");
-          Mouse.click(MOUSE_LEFT);
-        } else if (bitRead(actionToSend.keys[i].keyCode, 3)) {
-          debugfln("right click");
-          Mouse.click(MOUSE_RIGHT);
-        } else if (bitRead(actionToSend.keys[i].keyCode, 2)) {
-          debugfln("middle click");
-          Mouse.click(MOUSE_MIDDLE);
-        }
-      } else {
-        debugfln(" KEYBOARD_HID_TYPE");
-
-        Keyboard.press((KeyboardKeycode)actionToSend.keys[i].keyCode);
-        keyboardPressed = true;
-      }
+    if (actionToSend.keys[i].packed == 0)
+      continue;
 
+    if (actionToSend.keys[i].hidType() == MACRO_HID_TYPE) {
+      startMacro(actionToSend.keys[i].keyCode());
+    } else {
+      stageKey(actionToSend.keys[i], scrollAmount);
     }
   }
-}
 
-void releaseAction(controlAction actionToRelease) {
-  setIndicatorLed(0);
+  // the whole chord in one report per device
+  sendStagedKeys();
+}
 
-  debugf("Releasing key action '");
-  debug(actionToRelease.name);
-  debugfln("'");
+void releaseAction(const controlAction &actionToRelease) {
+  debugf("Releasing key action ");
+  debuglnfmt(actionToRelease.keys[0].packed, HEX);
 
-  if (keyboardPressed) {
-    Keyboard.releaseAll();
-    keyboardPressed = false;
-  }
+  // a macro runs to its end regardless
+  if (macroRunning())
+    return;
 
-  if (consumerPressed) {
-    Consumer.releaseAll();
-    consumerPressed = false;
-  }
+  releaseScheduled = false;
+  releaseKeys();
 }
 
-// send action and release the keys immediately after correct delay
-void sendActionAndRelease(controlAction actionToSend) {
+/* send action and schedule the release of the keys after the correct delay;
+   the release itself happens in serviceScheduledRelease() from loop() */
+void sendActionAndRelease(const controlAction &actionToSend, uint16_t scrollAmount = DEFAULT_SCROLL_AMOUNT) {
+
+  sendAction(actionToSend, scrollAmount);
 
-  sendAction(actionToSend);
+  // a macro releases its own keys
+  if (macroRunning())
+    return;
 
-  if (actionToSend.modeMask & LONG_KEY_DOWN_TIME) {
+  unsigned long keyDownTime = KEY_DOWN_TIME_REGULAR;
+  scheduledReleaseIsLong = (actionToSend.modeMask & LONG_KEY_DOWN_TIME);
+  if (scheduledReleaseIsLong) {
     debugfln("Using KEY_DOWN_TIME_LONG");
-    delay(KEY_DOWN_TIME_LONG);
-  } else {
-    delay(KEY_DOWN_TIME_REGULAR);
+    keyDownTime = KEY_DOWN_TIME_LONG;
+  }
 
+  scheduledReleaseAt = millis() + keyDownTime;
+  releaseScheduled = true;
+}
+
+/* Send the action for a batch of wheel detents, scaled by `percent` from the
+   acceleration curve. Scroll-only actions go out as a single report of the
+   scaled number of lines; anything else is repeated the scaled number of
+   times as back-to-back press/release reports, with only the last press held
+   for the normal key down time. */
+void sendWheelAction(const controlAction &action, uint8_t detents, uint16_t percent) {
+  uint16_t scrollAmount = actionOnlyScrolls(action);
+  if (scrollAmount) {
+    uint32_t scaled = (uint32_t)detents * scrollAmount * percent + accelCarry;
+    accelCarry = scaled % 100;
+    sendActionAndRelease(action, scaled / 100);
+    return;
   }
 
-  releaseAction(actionToSend);
+  uint32_t scaled = (uint32_t)detents * percent + accelCarry;
+  accelCarry = scaled % 100;
+  uint16_t repeats = scaled / 100;
+  if (repeats == 0)
+    return;
+
+  while (repeats-- > 1) {
+    sendAction(action);
+    releaseAction(action);
+  }
+  sendActionAndRelease(action);
+}
+
+/* Can the next wheel action be sent now? A regular-length press still waiting
+   for its release is simply cut short by the next one, but a long press is
+   allowed to run its full length, and so is a macro; detents stay in the
+   encoder queue. */
+bool readyForWheelAction() {
+  return !(releaseScheduled && scheduledReleaseIsLong) && !macroRunning();
 }
 
 void changeModeMessage() {
-  debugf("Changing control mode to ");
-  debug(currentModeIndex);
-  debugf(" '");
-  debug(currentMode().name);
-  debugfln("'");
+  trace(TRACE_MODE, currentModeIndex, previousModeIndex);
+
+  #ifdef ENABLE_DEBUGGING
+    char modeName[MAX_LABEL_LENGTH];
+    debugf("Changing control mode to ");
+    debug(currentModeIndex);
+    debugf(" '");
+    debug(loadModeName(modeName, currentModeIndex));
+    debugfln("'");
+  #endif
 }
 
 void returnToPreviousMode() {
@@ -292,6 +439,17 @@ void returnToPreviousMode() {
   updateDisplay();
 }
 
+/* Make a mode the current one, leaving quick-toggle mode if it is active */
+void selectMode(uint8_t modeIndex) {
+  updateLastAction();
+
+  currentModeIndex = modeIndex;
+  previousModeIndex = currentModeIndex;
+
+  changeModeMessage();
+  updateDisplay();
+}
+
 void toggleToggleMode() {
   if (currentModeIndex == toggleModeIndex) {
     if (previousModeIndex != toggleModeIndex) {
@@ -300,125 +458,352 @@ void toggleToggleMode() {
       debugfln("Toggle mode and previous mode are the same");
     }
   } else {
-    debugf("Temporary toggle to '");
-    debug(toggleMode().name);
-    debugfln("'");
+    #ifdef ENABLE_DEBUGGING
+      char modeName[MAX_LABEL_LENGTH];
+      debugf("Temporary toggle to '");
+      debug(loadModeName(modeName, toggleModeIndex));
+      debugfln("'");
+    #endif
 
     currentModeIndex = toggleModeIndex;
+    trace(TRACE_MODE, currentModeIndex, previousModeIndex);
+    updateDisplay();
+  }
+}
+
+void runCommand(uint8_t command) {
+  switch (command) {
+  case COMMAND_NEXT_MODE:
+    selectMode((currentModeIndex + 1 < numberOfModes) ? currentModeIndex + 1 : 0);
+    break;
+  case COMMAND_TOGGLE_MODE:
+    updateLastAction();
+    toggleToggleMode();
+    break;
+  case COMMAND_NEXT_LAYOUT:
+    nextLayout();
+    trace(TRACE_LAYOUT, currentLayoutIndex, 0);
+
+    oled.clear();
+    oled.print(F("Font: "));
+    oled.print(currentLayout().fontName);
+    delay(1000);
+    invalidateDisplay();
     updateDisplay();
+    break;
+  }
+}
+
+/* The command of a gesture, and into action the action it sends if that is
+   COMMAND_SEND_ACTION: its binding's, or for the button by itself, its role
+   in buttonRoles */
+uint8_t gestureCommand(const gestureEvent &event, controlAction &action) {
+  uint8_t command;
+  if (event.binding) {
+    command = pgm_read_byte(&event.binding->command);
+    if (command == COMMAND_SEND_ACTION)
+      action = loadGestureAction(event.binding);
+  } else {
+    const buttonRole *role = &buttonRoles[event.button];
+    command = pgm_read_byte(&role->command);
+    if (command == COMMAND_SEND_ACTION)
+      action = currentAction((actionSlot)pgm_read_byte(&role->slot));
+  }
+  return command;
+}
+
+void handleGesture(const gestureEvent &event) {
+  controlAction action;
+  uint8_t command = gestureCommand(event, action);
+
+  switch (event.kind) {
+  case GESTURE_TAP_DOWN:
+  case GESTURE_BINDING_DOWN:
+    if (command == COMMAND_SEND_ACTION) {
+      sendAction(action);
+    } else {
+      runCommand(command);
+    }
+    break;
+  case GESTURE_TAP_UP:
+  case GESTURE_BINDING_UP:
+    if (command == COMMAND_SEND_ACTION)
+      releaseAction(action);
+    break;
+  case GESTURE_TAP:
+    if (command == COMMAND_SEND_ACTION) {
+      sendActionAndRelease(action);
+    } else {
+      runCommand(command);
+    }
+    break;
   }
 }
 
+#ifdef ENABLE_INSTRUMENTATION
+// how many times each benchmark is repeated per mode and layout
+#define BENCHMARK_REPEATS 8
+
+// Do all of the queued drawing now
+void drainDisplay() {
+  while (displayStep(displayFields, NUMBER_OF_FIELDS));
+}
+
+/* Time the display and dispatch paths for every control mode with every
+   layout, printing the results over the serial port. The display really is
+   drawn on, but HID output is only counted, not sent. Takes a few seconds
+   per mode; buttons and the wheel are ignored meanwhile. Afterwards the mode,
+   layout and display are put back as they were. */
+void runBenchmarks() {
+  uint8_t savedModeIndex = currentModeIndex;
+  uint8_t savedPreviousModeIndex = previousModeIndex;
+  uint8_t savedLayoutIndex = currentLayoutIndex;
+
+  flushScheduledRelease();
+  stopMacro();
+  hidOutputMuted = true;
+
+  char modeName[MAX_LABEL_LENGTH];
+  uint32_t start, cycles;
+  uint16_t ops;
+
+  // sampling and debouncing the buttons, the part of readButtons() that runs every BUTTON_SAMPLE_TIME
+  cycles = 0;
+  for (uint8_t i = 0; i < BENCHMARK_REPEATS; i++) {
+    start = cycleCount();
+    debounceButtons(readButtonPins());
+    cycles += cycleCount() - start;
+  }
+  printBenchmark(F("readButtonPins + debounceButtons"), cycles, BENCHMARK_REPEATS, 0, 0);
+
+  for (uint8_t layout = 0; layout < numberOfLayouts; layout++) {
+    setLayout(layout);
+
+    for (uint8_t mode = 0; mode < numberOfModes; mode++) {
+      currentModeIndex = mode;
+      previousModeIndex = mode;
+
+      Serial.print(loadModeName(modeName, mode));
+      Serial.print(F(" / "));
+      Serial.println(currentLayout().fontName);
+
+      // building and laying out every field, without drawing
+      cycles = 0;
+      for (uint8_t i = 0; i < BENCHMARK_REPEATS; i++) {
+        invalidateDisplay();
+        displayFieldsBuilt = false;
+        start = cycleCount();
+        updateDisplay();
+        cycles += cycleCount() - start;
+      }
+      printBenchmark(F("updateDisplay (all fields)"), cycles, BENCHMARK_REPEATS, 0, 0);
+
+      // drawing the whole display, clear included
+      cycles = 0;
+      displayBusBytes = 0;
+      for (uint8_t i = 0; i < BENCHMARK_REPEATS; i++) {
+        invalidateDisplay();
+        updateDisplay();
+        start = cycleCount();
+        drainDisplay();
+        cycles += cycleCount() - start;
+      }
+      printBenchmark(F("draw full display"), cycles, BENCHMARK_REPEATS, displayBusBytes, 0);
+
+      // toggling to the quick-toggle mode and back, redrawing what changed
+      cycles = 0;
+      displayBusBytes = 0;
+      for (uint8_t i = 0; i < BENCHMARK_REPEATS; i++) {
+        start = cycleCount();
+        toggleToggleMode();
+        drainDisplay();
+        toggleToggleMode();
+        drainDisplay();
+        cycles += cycleCount() - start;
+      }
+      printBenchmark(F("toggleToggleMode + draw"), cycles, 2 * BENCHMARK_REPEATS, displayBusBytes, 0);
+
+      // pressing and releasing every bound action
+      cycles = 0;
+      ops = 0;
+      hidReportCount = 0;
+      for (uint8_t slot = 0; slot < NUMBER_OF_ACTION_SLOTS; slot++) {
+        if (!actionIsBound(mode, (actionSlot)slot))
+          continue;
+        controlAction action = loadAction(mode, (actionSlot)slot);
+        for (uint8_t i = 0; i < BENCHMARK_REPEATS; i++) {
+          start = cycleCount();
+          sendAction(action);
+          releaseAction(action);
+          cycles += cycleCount() - start;
+          stopMacro();
+          ops++;
+        }
+      }
+      if (ops > 0)
+        printBenchmark(F("sendAction + releaseAction"), cycles, ops, 0, hidReportCount);
+    }
+  }
+
+  stopMacro();
+  hidOutputMuted = false;
+
+  currentModeIndex = savedModeIndex;
+  previousModeIndex = savedPreviousModeIndex;
+  setLayout(savedLayoutIndex);
+  invalidateDisplay();
+  updateDisplay();
+  Serial.println(F("Benchmarks done"));
+}
+#endif
+
 void loop() {
+  instrumentLoopStart();
+
   readButtons();
+  traceButtons();
 
   unsigned long currentMillis = millis(); 
 
+  serviceScheduledRelease(currentMillis);
+
+  serviceMacro();
+
   if (nextOutput < currentMillis) {
     nextOutput = currentMillis + OUTPUT_EVERY;
 
-    debug(currentMillis);
-    debugf(" Current Control Mode is '");
-    debug(currentMode().name);
-    debugfln("'");
+    #ifdef ENABLE_DEBUGGING
+      char modeName[MAX_LABEL_LENGTH];
+      debug(currentMillis);
+      debugf(" Current Control Mode is '");
+      debug(loadModeName(modeName, currentModeIndex));
+      debugfln("'");
+      debugf("Encoder queue overflows: ");
+      debug(encoderOverflowCount());
+      debugf(", invalid transitions: ");
+      debug(encoderInvalidCount());
+      debugf(", bounced: ");
+      debugln(encoderBouncedCount());
+    #endif
 
     // updateDisplay();
 
     if (!screensaverEnabled && (lastAction > SCREENSAVER_STARTS_IN) && (lastAction < currentMillis - SCREENSAVER_STARTS_IN)) {
       screensaverEnabled = true;
+      screensaverStarted = currentMillis;
+      dimDisplay(true);
     }
 
-    if (screensaverEnabled) {
+    if (screensaverEnabled && !displayAsleep) {
+      invalidateDisplay();
       oled.clear();
-      oled.setCursor(random(0, oled.displayWidth()-oled.strWidth(screensaverText)), random(0, displayHeightInRows));
-      oled.print(screensaverText);
+      if ((DISPLAY_SLEEPS_IN > 0) && (currentMillis - screensaverStarted >= DISPLAY_SLEEPS_IN)) {
+        sleepDisplay(true);
+      } else {
+        oled.setCursor(random(0, oled.displayWidth()-oled.strWidth(screensaverText)), random(0, displayHeightInRows));
+        oled.print(screensaverText);
+      }
     }
   }
 
-  if (upButton.isPressed() && middleButton.wasPressed()) {
-    nextLayout();
+  pollGestures(currentModeIndex, currentMillis);
+  for (uint8_t i = 0; i < gestureEventCount; i++) {
+    handleGesture(gestureEvents[i]);
+  }
 
-    oled.clear();
-    oled.print(F("Font: "));
-    oled.print(currentLayout().fontName);
-    delay(1000);
+  /* take every detent queued since the last loop as one batch, stopping at a
+     change of direction */
+  if (readyForWheelAction()) {
+    int8_t detents = takeEncoderDetents(wheelDetentsPending, 127 - abs(wheelDetentsPending));
+    if (detents != 0)
+      trace(TRACE_DETENTS, 0, detents);
+    if (wheelDetentsPending == 0)
+      wheelDetentsPendingSince = oldestTakenDetentTime;
+    wheelDetentsPending += detents;
+  }
+
+  // check if the accelerated wheel actions should be used
+  uint16_t velocity = wheelVelocity();
+  if (!isAccelerated && (velocity >= WHEEL_ACCEL_VELOCITY)) {
+    isAccelerated = true;
+    updateDisplay();
+  } else if (isAccelerated && (velocity < WHEEL_ACCEL_VELOCITY / 2)) {
+    isAccelerated = false;
     updateDisplay();
+  }
 
-  } else if (leftButton.wasPressed()) {
-    sendAction(currentMode().left);
-  } else if (leftButton.wasReleased()) {
-    releaseAction(currentMode().left);
-  } else if (rightButton.wasPressed()) {
-    sendAction(currentMode().right);
-  } else if (rightButton.wasReleased()) {
-    releaseAction(currentMode().right);
-  } else if (middleButton.wasPressed()) {
-    sendAction(currentMode().middle);
-  } else if (middleButton.wasReleased()) {
-    releaseAction(currentMode().middle);
-
-  } else if (upButton.wasPressed()) {
-    updateLastAction();
+  if (velocity == 0) {
+    accelCarry = 0;
+  }
 
-    currentModeIndex++;
-    if (currentModeIndex >= numberOfModes) {
-      currentModeIndex = 0;
+  if (readyForWheelAction() && (wheelDetentsPending != 0)) {
+    actionSlot slot;
+    if (wheelDetentsPending < 0) {
+      debugf("CCW: ");
+      slot = ((isAccelerated) && actionIsBound(currentModeIndex, WHEEL_CCW_ACCEL_ACTION)) ? WHEEL_CCW_ACCEL_ACTION : WHEEL_CCW_ACTION;
+    } else {
+      debugf("CW: ");
+      slot = ((isAccelerated) && actionIsBound(currentModeIndex, WHEEL_CW_ACCEL_ACTION)) ? WHEEL_CW_ACCEL_ACTION : WHEEL_CW_ACTION;
+    }
+    debug(wheelDetentsPending);
+    debugf(" at ");
+    debug(velocity);
+    debugfln(" detents/s");
+
+    uint16_t percent = accelPercent(currentModeIndex, velocity);
+
+    controlAction action = currentAction(slot);
+    if (action.modeMask & LONG_KEY_DOWN_TIME) {
+      // long presses can't be batched or scaled; leave the rest for later loops
+      int8_t direction = (wheelDetentsPending < 0) ? -1 : 1;
+      sendWheelAction(action, 1, 100);
+      wheelDetentsPending -= direction;
+    } else {
+      sendWheelAction(action, abs(wheelDetentsPending), percent);
+      wheelDetentsPending = 0;
     }
-    previousModeIndex = currentModeIndex;
-
-    changeModeMessage();
-    updateDisplay();
-  } else if (downButton.wasPressed()) {
-    updateLastAction();
 
-    toggleToggleMode();
+    instrumentMicrosEnd(DETENT_LATENCY_STAT, wheelDetentsPendingSince);
   }
 
-  if (encoderTurned != 0) {
-    clickAccelCount += abs(encoderTurned);
+  if (displayBusy(displayFields, NUMBER_OF_FIELDS)) {
+    instrumentMicrosStart(sliceStart);
+    serviceDisplay(displayFields, NUMBER_OF_FIELDS);
+    instrumentMicrosEnd(DISPLAY_SLICE_STAT, sliceStart);
   }
 
-  // check if acceleration should happen
-  if (nextClickAccelCheck <= currentMillis) {
-    nextClickAccelCheck = currentMillis + CLICK_ACCEL_EVERY;
+  serialCommandsPoll();
 
-    if (clickAccelCount >= CLICK_ACCEL_TRIGGER) {
-      if (!isAccelerated) {
-        isAccelerated = true;
-        // updateDisplay();
-      }
-    } else {
-      if (isAccelerated) {
-        isAccelerated = false;
-        // updateDisplay();
-      }
+  #ifdef ENABLE_INSTRUMENTATION
+    if (benchmarkRequested) {
+      benchmarkRequested = false;
+      runBenchmarks();
     }
+  #endif
+
+  if (modeListChanged) {
+    resetModes();
+    invalidateDisplay();
+    updateDisplay();
+  }
 
-    clickAccelCount = 0;
+  if (hostRequestedMode != NO_MODE_REQUEST) {
+    debugfln("Host selected a mode");
+    selectMode(hostRequestedMode);
+    hostRequestedMode = NO_MODE_REQUEST;
   }
 
-  if (encoderTurned < 0) {
-    debugf("CCW: ");
-    debugln(encoderTurned);
-    encoderTurned++;
-    if ((isAccelerated) && (currentMode().wheelCCWAccel.keys[0].keyCode > 0)){
-      sendActionAndRelease(currentMode().wheelCCWAccel);
-    } else {
-      sendActionAndRelease(currentMode().wheelCCW);
-    }
-  } else if (encoderTurned > 0) {
-    debugf("CW: ");
-    debugln(encoderTurned);
-    encoderTurned--;
-    if ((isAccelerated) && (currentMode().wheelCWAccel.keys[0].keyCode > 0)) {
-      sendActionAndRelease(currentMode().wheelCWAccel);
-    } else {
-      sendActionAndRelease(currentMode().wheelCW);
-    }
+  expireTransientLabel(currentMillis);
+  if (!screensaverEnabled && (displayedTransientLabelVersion != transientLabelVersion)) {
+    updateDisplay();
   }
 
   if (inToggleMode() && (lastAction < currentMillis - TOGGLE_MODE_EXPIRES_IN)) {
     debugfln("Toggle Mode expired; Returning to previous mode");
     returnToPreviousMode();
   }
+
+  if (!releaseScheduled && !macroRunning() && (wheelDetentsPending == 0) && !displayBusy(displayFields, NUMBER_OF_FIELDS)) {
+    idleSleep();
+  }
 }
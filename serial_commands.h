@@ -0,0 +1,200 @@
+#ifndef SERIAL_COMMANDS_H
+#define SERIAL_COMMANDS_H
+
+#include "config.h"
+#include "instrumentation.h"
+#include "encoder.h"
+#include "mode_storage.h"
+#include "host_control.h"
+#include "trace.h"
+
+/*
+Commands accepted over the serial port, each a single character:
+
+  s   print timing statistics and the encoder's error counts
+      (ENABLE_INSTRUMENTATION)
+  r   reset timing statistics (ENABLE_INSTRUMENTATION)
+  b   run the benchmarks and print their results (ENABLE_INSTRUMENTATION)
+  u   upload a mode image to EEPROM (ENABLE_MODE_UPLOAD): followed by "SW",
+      the image length and the CRC-16 of the whole image (as in
+      mode_storage.h) as little-endian uint16s, and then the image itself.
+      Answered with "OK <number of modes>" or "ERR <reason>" once done.
+  x   erase the mode image, going back to the built-in modes
+      (ENABLE_MODE_UPLOAD): followed by "SW". Answered with "OK 0".
+  m   select a control mode (ENABLE_HOST_CONTROL): followed by its name or
+      index and a newline. Answered with "OK <index>" or "ERR unknown mode".
+  l   show a transient label for TRANSIENT_LABEL_TIME (ENABLE_HOST_CONTROL):
+      followed by the text and a newline; an empty text removes it.
+      Answered with "OK".
+  t   dump the trace of recent events in binary (ENABLE_TRACE, see trace.h)
+
+Anything else is ignored, and a 'u' or 'x' without its "SW" is refused, so
+stray bytes on the port can't replace or erase the modes. A command whose
+argument doesn't arrive within SERIAL_COMMAND_TIMEOUT is answered with
+"ERR timeout".
+*/
+
+#if defined(ENABLE_INSTRUMENTATION) || defined(ENABLE_MODE_UPLOAD) || defined(ENABLE_HOST_CONTROL) || defined(ENABLE_TRACE)
+  #define SERIAL_COMMANDS
+#endif
+
+#ifdef SERIAL_COMMANDS
+/* A command's argument is collected a byte at a time over as many loops as
+   it takes to arrive, so a slow host never stalls the loop. Give up on it
+   after this long; milliseconds */
+#define SERIAL_COMMAND_TIMEOUT 1000
+
+// commandArgumentSize() of a command whose argument is a line of text
+#define LINE_ARGUMENT 0xFF
+
+// the command whose argument is still arriving, 0 when there is none
+uint8_t pendingCommand = 0;
+char commandArgument[MAX_LABEL_LENGTH];
+uint8_t commandArgumentLength = 0;
+unsigned long commandStarted = 0; // millis()
+
+static_assert(MAX_LABEL_LENGTH >= 6, "commandArgument holds the 'u' frame");
+
+/* How many bytes follow a command, LINE_ARGUMENT if a line does (its end
+   dropped past MAX_LABEL_LENGTH - 1 characters) */
+uint8_t commandArgumentSize(uint8_t command) {
+  switch (command) {
+  #ifdef ENABLE_MODE_UPLOAD
+    case 'u':
+      return 6; // "SW", length, CRC
+    case 'x':
+      return 2; // "SW"
+  #endif
+  #ifdef ENABLE_HOST_CONTROL
+    case 'm':
+    case 'l':
+      return LINE_ARGUMENT;
+  #endif
+  }
+  return 0;
+}
+
+// Take what has arrived of the pending command's argument; true once it is all there
+bool readCommandArgument() {
+  uint8_t size = commandArgumentSize(pendingCommand);
+  while (Serial.available()) {
+    int c = Serial.read();
+    if (size != LINE_ARGUMENT) {
+      commandArgument[commandArgumentLength++] = c;
+      if (commandArgumentLength == size)
+        return true;
+    } else if (c == '\n') {
+      commandArgument[commandArgumentLength] = '\0';
+      return true;
+    } else if ((c != '\r') && (commandArgumentLength < sizeof(commandArgument) - 1)) {
+      commandArgument[commandArgumentLength++] = c;
+    }
+  }
+  return false;
+}
+
+#ifdef ENABLE_MODE_UPLOAD
+// does the argument start with the "SW" that 'u' and 'x' need?
+bool commandFramed() {
+  if ((commandArgument[0] == 'S') && (commandArgument[1] == 'W'))
+    return true;
+  Serial.println(F("ERR frame"));
+  return false;
+}
+
+uint16_t commandArgumentWord(uint8_t at) {
+  return (uint8_t)commandArgument[at] | ((uint16_t)(uint8_t)commandArgument[at + 1] << 8);
+}
+#endif
+
+// Carry out a command, with its argument in commandArgument
+void runSerialCommand(uint8_t command) {
+  switch (command) {
+  #ifdef ENABLE_INSTRUMENTATION
+    case 's':
+      printTimingStats();
+      printEncoderStats();
+      break;
+    case 'r':
+      resetTimingStats();
+      Serial.println(F("Timing statistics reset"));
+      break;
+    case 'b':
+      benchmarkRequested = true;
+      break;
+  #endif
+
+  #ifdef ENABLE_MODE_UPLOAD
+    case 'u':
+      if (commandFramed())
+        beginModeUpload(commandArgumentWord(2), commandArgumentWord(4));
+      break;
+    case 'x':
+      if (commandFramed())
+        eraseModeImage();
+      break;
+  #endif
+
+  #ifdef ENABLE_HOST_CONTROL
+    case 'm': {
+      uint8_t modeIndex = findRequestedMode(commandArgument);
+      if (modeIndex == NO_MODE_REQUEST) {
+        Serial.println(F("ERR unknown mode"));
+        break;
+      }
+      hostRequestedMode = modeIndex;
+      Serial.print(F("OK "));
+      Serial.println(modeIndex);
+      break;
+    }
+    case 'l':
+      setTransientLabel(commandArgument);
+      Serial.println(F("OK"));
+      break;
+  #endif
+
+  #ifdef ENABLE_TRACE
+    case 't':
+      dumpTrace();
+      break;
+  #endif
+  }
+}
+
+// Check the serial port for a command; to be called once per loop
+void serialCommandsPoll() {
+  #ifdef ENABLE_MODE_UPLOAD
+    if (modeUploadInProgress) {
+      modeUploadPoll();
+      return;
+    }
+  #endif
+
+  if (!pendingCommand) {
+    if (!Serial.available())
+      return;
+
+    uint8_t command = Serial.read();
+    if (!commandArgumentSize(command)) {
+      runSerialCommand(command);
+      return;
+    }
+    pendingCommand = command;
+    commandArgumentLength = 0;
+    commandStarted = millis();
+  }
+
+  if (readCommandArgument()) {
+    uint8_t command = pendingCommand;
+    pendingCommand = 0;
+    runSerialCommand(command);
+  } else if (millis() - commandStarted > SERIAL_COMMAND_TIMEOUT) {
+    pendingCommand = 0;
+    Serial.println(F("ERR timeout"));
+  }
+}
+#else
+  #define serialCommandsPoll()
+#endif
+
+#endif
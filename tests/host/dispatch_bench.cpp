@@ -0,0 +1,102 @@
+/*
+Throughput of the display and dispatch paths on the simulated board (sim.h),
+for every control mode with every layout: the same work runBenchmarks() times
+on the board with ENABLE_INSTRUMENTATION. For each it prints the operations
+per simulated second and the display bytes and HID reports each one takes.
+Run with `make bench`.
+
+As in latency_bench, only the display bus, USB polling and a fixed cost per
+loop take simulated time, so this shows how much each path sends, not how
+fast its code runs on the 32u4.
+*/
+
+#include "sketch.h"
+
+// how many times each benchmark is repeated per mode and layout
+#define REPEATS 8
+
+// Do all of the queued drawing now
+static void drain() {
+  while (displayStep(displayFields, NUMBER_OF_FIELDS));
+}
+
+struct benchmarkStart {
+  unsigned long micros = simMicros;
+  unsigned long displayBytes = simDisplayBytes;
+  size_t hidReports = simHidReports.size();
+};
+
+/* Operations that sent nothing took no simulated time, so they have no rate:
+   e.g. toggling in the quick-toggle mode itself */
+static void printResult(const char *name, const benchmarkStart &start, unsigned ops) {
+  unsigned long took = simMicros - start.micros;
+  char rate[12] = "-";
+  if (took > 0)
+    snprintf(rate, sizeof (rate), "%.0f", ops * 1e6 / took);
+  printf("  %-28s %5u %10s %9.1f %7.1f\n", name, ops, rate,
+         (double)(simDisplayBytes - start.displayBytes) / ops,
+         (double)(simHidReports.size() - start.hidReports) / ops);
+}
+
+static void benchMode(uint8_t mode) {
+  currentModeIndex = mode;
+  previousModeIndex = mode;
+  invalidateDisplay();
+  updateDisplay();
+  drain();
+
+  char modeName[MAX_LABEL_LENGTH];
+  printf("%s / %s\n", loadModeName(modeName, mode), currentLayout().fontName);
+
+  // building, laying out and drawing every field, clear included
+  benchmarkStart start;
+  for (unsigned i = 0; i < REPEATS; i++) {
+    invalidateDisplay();
+    updateDisplay();
+    drain();
+  }
+  printResult("updateDisplay + draw all", start, REPEATS);
+
+  // toggling to the quick-toggle mode and back, redrawing what changed
+  start = benchmarkStart();
+  for (unsigned i = 0; i < REPEATS; i++) {
+    toggleToggleMode();
+    drain();
+    toggleToggleMode();
+    drain();
+  }
+  printResult("toggleToggleMode + draw", start, 2 * REPEATS);
+
+  // pressing and releasing every bound action; macros run to their end
+  start = benchmarkStart();
+  unsigned ops = 0;
+  for (uint8_t slot = 0; slot < NUMBER_OF_ACTION_SLOTS; slot++) {
+    if (!actionIsBound(mode, (actionSlot)slot))
+      continue;
+    controlAction action = loadAction(mode, (actionSlot)slot);
+    for (unsigned i = 0; i < REPEATS; i++) {
+      sendAction(action);
+      releaseAction(action);
+      while (macroRunning()) {
+        simLoop();
+      }
+      ops++;
+    }
+  }
+  if (ops > 0)
+    printResult("sendAction + releaseAction", start, ops);
+}
+
+int main() {
+  simPowerOn();
+  simRunUntil(1000000); // until the first full draw of the display is done
+
+  printf("  %-28s %5s %10s %9s %7s\n", "", "ops", "ops/s", "disp B/op", "HID/op");
+  for (uint8_t layout = 0; layout < numberOfLayouts; layout++) {
+    setLayout(layout);
+    for (uint8_t mode = 0; mode < numberOfModes; mode++) {
+      benchMode(mode);
+    }
+  }
+  return 0;
+}
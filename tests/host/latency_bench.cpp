@@ -0,0 +1,137 @@
+/*
+Input-to-report latency of the sketch as built by config.h, on the simulated
+board (sim.h): scripted button presses and wheel turns go in, and the HID
+reports the host would poll come out. For each scenario it prints how long
+the inputs took to reach the host, how many were lost, and how long loop()
+ran for. Run with `make bench`.
+
+Times are simulated, not measured: only the display bus, USB polling and a
+fixed cost per loop take time, so they show where the sketch waits, not how
+fast its code runs on the 32u4.
+*/
+
+#include "sketch.h"
+
+// the keyboard and consumer reports with a key down, after `from`
+static std::vector<unsigned long> keyPresses(unsigned long from) {
+  std::vector<unsigned long> times;
+  for (const simHidReport &report : simHidReports) {
+    if ((report.time < from) || ((report.id != HID_REPORTID_CONSUMERCONTROL) && (report.id != HID_REPORTID_KEYBOARD)))
+      continue;
+    for (uint8_t b : report.data) {
+      if (b) {
+        times.push_back(report.time);
+        break;
+      }
+    }
+  }
+  return times;
+}
+
+struct loopTimes {
+  unsigned long count = 0;
+  unsigned long total = 0;
+  unsigned long max = 0;
+};
+
+static loopTimes runUntil(unsigned long until) {
+  loopTimes times;
+  while (simMicros < until) {
+    unsigned long t = simLoop();
+    times.count++;
+    times.total += t;
+    if (t > times.max)
+      times.max = t;
+  }
+  return times;
+}
+
+static uint16_t encoderErrors() {
+  return encoderOverflowCount() + encoderInvalidCount() + encoderBouncedCount();
+}
+
+/* Each input is matched to the first report at or after it that no earlier
+   input was matched to */
+static void printResult(const char *name, const std::vector<unsigned long> &inputs,
+                        const std::vector<unsigned long> &reports, unsigned dropped, const loopTimes &loops) {
+  unsigned long total = 0, worst = 0;
+  unsigned matched = 0;
+  size_t r = 0;
+  for (unsigned long input : inputs) {
+    while ((r < reports.size()) && (reports[r] < input)) {
+      r++;
+    }
+    if (r >= reports.size())
+      break;
+    unsigned long latency = reports[r++] - input;
+    total += latency;
+    if (latency > worst)
+      worst = latency;
+    matched++;
+  }
+
+  printf("%-30s %6zu %6u %7lu %7lu %6u %7lu %7lu\n", name, inputs.size(), matched,
+         matched ? total / matched : 0, worst, dropped,
+         loops.count ? loops.total / loops.count : 0, loops.max);
+}
+
+static void benchButtons(const char *name, uint8_t bounces) {
+  simPowerOn();
+  runUntil(1000000); // until the first full draw of the display is done
+  unsigned long start = simMicros;
+
+  std::vector<unsigned long> presses;
+  for (int i = 0; i < 20; i++) {
+    unsigned long at = start + 1000 + i * 300000UL + (i * 137) % 1000;
+    simSchedulePress(at, BUTTON_LEFT, 80000, bounces);
+    presses.push_back(at);
+  }
+  loopTimes loops = runUntil(start + 20 * 300000UL + 100000);
+
+  std::vector<unsigned long> reports = keyPresses(start);
+  printResult(name, presses, reports, (reports.size() < presses.size()) ? presses.size() - reports.size() : 0, loops);
+}
+
+static void benchWheel(const char *name, unsigned rate, bool redraw) {
+  simPowerOn();
+  runUntil(1000000); // until the first full draw of the display is done
+  unsigned long start = simMicros;
+  unsigned long interval = 1000000UL / rate;
+  unsigned detents = rate < 20 ? 20 : rate;
+
+  uint16_t errorsBefore = encoderErrors();
+  std::vector<unsigned long> inputs;
+  unsigned long at = start + 1000;
+  if (redraw) {
+    // the next mode: its labels are drawn while the wheel turns
+    simSchedulePress(at, BUTTON_UP, 30000);
+    at += 20000;
+  }
+  simScheduleDetents(at, detents, interval);
+  for (unsigned d = 0; d < detents; d++) {
+    inputs.push_back(at + d * interval + (ENCODER_STEPS_PER_DETENT - 1) * interval / ENCODER_STEPS_PER_DETENT);
+  }
+  loopTimes loops = runUntil(at + detents * interval + 2000000UL);
+
+  std::vector<unsigned long> reports = keyPresses(start);
+  unsigned dropped = encoderErrors() - errorsBefore;
+  if (reports.size() < detents)
+    dropped = detents - reports.size();
+  printResult(name, inputs, reports, dropped, loops);
+}
+
+int main() {
+  printf("%-30s %6s %6s %7s %7s %6s %7s %7s\n", "", "inputs", "sent", "avg us", "max us", "lost", "loop us", "max");
+
+  benchButtons("button, clean", 0);
+  benchButtons("button, 3 bounces", 3);
+
+  static const unsigned rates[] = {5, 20, 50, 100, 200, 400};
+  char name[40];
+  for (unsigned rate : rates) {
+    snprintf(name, sizeof (name), "wheel %u/s", rate);
+    benchWheel(name, rate, false);
+  }
+  benchWheel("wheel 50/s while redrawing", 50, true);
+  return 0;
+}
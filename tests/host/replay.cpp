@@ -0,0 +1,176 @@
+/*
+Replays the inputs of an event trace on the simulated board (sim.h) and
+writes the trace of the replay, for comparing the HID output of the sketch
+as it is now with what the controller sent in the field:
+
+  trace.py --inputs field.trace > field.inputs
+  build/replay field.inputs replayed.trace
+  trace.py --diff field.trace replayed.trace
+
+The inputs are the ones trace.py --inputs prints. The replay starts from
+power-on, in DEFAULT_MODE with the first layout, so the field trace should
+start there too. Each button edge is seen at its time, and each batch of
+detents is turned in the millisecond before it and taken as one batch, so
+the replay traces the same inputs at the same times as long as the sketch
+isn't still busy with an earlier input.
+
+The trace is collected after every loop rather than kept in the TRACE_SIZE
+ring buffer, so a long replay loses nothing.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sketch.h"
+
+struct replayInput {
+  unsigned long millis; // from the first input
+  bool isButton;
+  uint8_t button;
+  bool down;
+  int detents;
+};
+
+static const char *buttonNames[NUMBER_OF_BUTTONS] = {"middle", "up", "down", "left", "right"};
+
+static bool parseInputs(FILE *file, std::vector<replayInput> &inputs) {
+  char line[80];
+  for (unsigned number = 1; fgets(line, sizeof (line), file); number++) {
+    replayInput input = {};
+    char kind[16], name[16], edge[16];
+    if ((line[0] == '\n') || (line[0] == '#')) {
+      continue;
+    } else if (sscanf(line, "%lu %15s %15s %15s", &input.millis, kind, name, edge) == 4
+               && (strcmp(kind, "button") == 0)) {
+      input.isButton = true;
+      while ((input.button < NUMBER_OF_BUTTONS) && strcmp(name, buttonNames[input.button])) {
+        input.button++;
+      }
+      input.down = (strcmp(edge, "down") == 0);
+      if ((input.button >= NUMBER_OF_BUTTONS) || (!input.down && strcmp(edge, "up"))) {
+        fprintf(stderr, "line %u: unknown button edge: %s", number, line);
+        return false;
+      }
+    } else if ((sscanf(line, "%lu %15s %d", &input.millis, kind, &input.detents) != 3)
+               || (strcmp(kind, "detents") != 0) || (input.detents == 0)) {
+      fprintf(stderr, "line %u: not an input: %s", number, line);
+      return false;
+    }
+    if (!inputs.empty() && (input.millis < inputs.back().millis)) {
+      fprintf(stderr, "line %u: inputs out of order\n", number);
+      return false;
+    }
+    inputs.push_back(input);
+  }
+  return true;
+}
+
+static std::vector<traceEvent> replayedEvents;
+
+// Move what the last loop traced out of the ring buffer
+static void collectTrace() {
+  uint8_t i = (traceNext + TRACE_SIZE - traceCount) % TRACE_SIZE;
+  for (uint8_t n = 0; n < traceCount; n++) {
+    replayedEvents.push_back(traceBuffer[i]);
+    if (++i >= TRACE_SIZE)
+      i = 0;
+  }
+  traceCount = 0;
+}
+
+static void loopUntil(unsigned long micros) {
+  while (simMicros < micros) {
+    simLoop();
+    collectTrace();
+  }
+}
+
+static void writeWord(FILE *file, uint16_t value) {
+  fputc(value & 0xFF, file);
+  fputc(value >> 8, file);
+}
+
+// The collected events, in the format of dumpTrace()
+static void writeDump(FILE *file) {
+  unsigned long now = millis();
+  fputc('T', file);
+  fputc('R', file);
+  fputc(TRACE_FORMAT_VERSION, file);
+  fputc(sizeof (traceEvent), file);
+  writeWord(file, replayedEvents.size());
+  writeWord(file, 0);
+  writeWord(file, now & 0xFFFF);
+  writeWord(file, now >> 16);
+  for (const traceEvent &event : replayedEvents) {
+    writeWord(file, event.time);
+    fputc(event.type, file);
+    fputc(event.arg, file);
+    writeWord(file, event.value);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <inputs> <trace dump to write>\n", argv[0]);
+    return 2;
+  }
+
+  FILE *file = fopen(argv[1], "r");
+  if (!file) {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<replayInput> inputs;
+  bool parsed = parseInputs(file, inputs);
+  fclose(file);
+  if (!parsed)
+    return 1;
+
+  simPowerOn();
+  loopUntil(1000000); // until the first full draw of the display is done
+  replayedEvents.clear();
+  traceClockKnown = false;
+
+  // on a millisecond, so the inputs are traced at the same millis() offsets
+  unsigned long start = (simMicros / 1000 + 1) * 1000;
+  unsigned long previous = simMicros;
+  for (size_t i = 0; i < inputs.size(); ) {
+    unsigned long at = start + inputs[i].millis * 1000;
+    loopUntil(at - 1000);
+    if (simMicros < at - 1000)
+      simAdvance(at - 1000 - simMicros);
+
+    // everything at this millisecond goes in before the loop that takes it
+    for (; (i < inputs.size()) && (start + inputs[i].millis * 1000 == at); i++) {
+      const replayInput &input = inputs[i];
+      if (input.isButton) {
+        simSchedulePin(at, simButtonPins[input.button], input.down ? LOW : HIGH);
+      } else {
+        unsigned long from = (previous > simMicros) ? previous : simMicros;
+        simScheduleDetents(from, input.detents, (at - from) / abs(input.detents));
+      }
+    }
+    // no loop until then, or it would take the detents a few at a time
+    if (simMicros < at)
+      simAdvance(at - simMicros);
+    lastButtonSample = millis() - BUTTON_SAMPLE_TIME; // see the edges now
+    simLoop();
+    collectTrace();
+    previous = simMicros;
+  }
+  loopUntil(simMicros + 2000000); // scheduled releases, macros and gesture windows
+
+  if (replayedEvents.size() > 0xFFFF) {
+    fprintf(stderr, "too many events for one trace dump\n");
+    return 1;
+  }
+
+  file = fopen(argv[2], "wb");
+  if (!file) {
+    perror(argv[2]);
+    return 1;
+  }
+  writeDump(file);
+  fclose(file);
+  return 0;
+}
@@ -0,0 +1,436 @@
+#include "sim.h"
+
+#include <stdio.h>
+#include <deque>
+#include <map>
+
+#include "HID-Project.h"
+#include "SSD1306Ascii.h"
+#include "Wire.h"
+
+// defined by the sketch
+void loop();
+
+unsigned long simMicros = 0;
+
+void (*simPinChangeHandler)(uint8_t pin) = NULL;
+
+std::string simSerialOutput;
+uint8_t simEeprom[E2END + 1];
+unsigned long simEepromWrites = 0;
+std::vector<simHidReport> simHidReports;
+std::vector<uint8_t> simControlReply;
+unsigned long simDisplayBytes = 0;
+
+static uint8_t pinLevels[SIM_PINS];
+static std::multimap<unsigned long, std::pair<uint8_t, uint8_t>> scheduledPins;
+static std::deque<uint8_t> serialInput;
+static unsigned long usbEndpointFreeAt[16];
+static std::deque<uint8_t> controlData;
+
+volatile uint8_t PINB, PINC, PIND, PINE, PINF;
+volatile uint8_t PCICR, PCMSK0, PCIFR;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+volatile uint16_t TCNT1;
+volatile uint8_t ADCSRA;
+
+void simReset() {
+  simMicros = 0;
+  for (uint8_t i = 0; i < SIM_PINS; i++) {
+    pinLevels[i] = HIGH;
+  }
+  scheduledPins.clear();
+  serialInput.clear();
+  simSerialOutput.clear();
+  memset(simEeprom, 0xFF, sizeof (simEeprom));
+  simEepromWrites = 0;
+  simHidReports.clear();
+  simDisplayBytes = 0;
+  memset(usbEndpointFreeAt, 0, sizeof usbEndpointFreeAt);
+}
+
+void simSetPin(uint8_t pin, uint8_t level) {
+  if (pinLevels[pin] == level)
+    return;
+  pinLevels[pin] = level;
+  if (simPinChangeHandler)
+    simPinChangeHandler(pin);
+}
+
+void simSchedulePin(unsigned long at, uint8_t pin, uint8_t level) {
+  scheduledPins.insert(std::make_pair(at, std::make_pair(pin, level)));
+}
+
+uint8_t simPinLevel(uint8_t pin) {
+  return pinLevels[pin];
+}
+
+void simAdvance(unsigned long micros) {
+  unsigned long until = simMicros + micros;
+  while (!scheduledPins.empty() && (scheduledPins.begin()->first <= until)) {
+    auto change = *scheduledPins.begin();
+    scheduledPins.erase(scheduledPins.begin());
+    if (change.first > simMicros)
+      simMicros = change.first;
+    simSetPin(change.second.first, change.second.second);
+  }
+  simMicros = until;
+}
+
+unsigned long simLoop() {
+  unsigned long start = simMicros;
+  simAdvance(0);
+  loop();
+  simAdvance(SIM_LOOP_MICROS);
+  return simMicros - start;
+}
+
+void simRunUntil(unsigned long micros) {
+  while (simMicros < micros) {
+    simLoop();
+  }
+}
+
+void simSerialSend(const char *text) {
+  simSerialSend((const uint8_t *)text, strlen(text));
+}
+
+void simSerialSend(const uint8_t *data, size_t length) {
+  serialInput.insert(serialInput.end(), data, data + length);
+}
+
+// Arduino core
+
+unsigned long millis() {
+  return simMicros / 1000;
+}
+
+unsigned long micros() {
+  return simMicros;
+}
+
+void delay(unsigned long ms) {
+  simAdvance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  simAdvance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+int digitalRead(uint8_t pin) {
+  return pinLevels[pin];
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  pinLevels[pin] = value;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+}
+
+long random(long howBig) {
+  return howBig ? rand() % howBig : 0;
+}
+
+long random(long howSmall, long howBig) {
+  return (howBig > howSmall) ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+#if defined(__GLIBC__) && ((__GLIBC__ < 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ < 38)))
+size_t strlcpy(char *dest, const char *src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t n = (length < size - 1) ? length : size - 1;
+    memcpy(dest, src, n);
+    dest[n] = '\0';
+  }
+  return length;
+}
+
+size_t strlcat(char *dest, const char *src, size_t size) {
+  size_t used = strnlen(dest, size);
+  if (used == size)
+    return size + strlen(src);
+  return used + strlcpy(dest + used, src, size - used);
+}
+#endif
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper *s) {
+  return write((const char *)s);
+}
+
+size_t Print::print(const char *s) {
+  return write(s);
+}
+
+size_t Print::print(char c) {
+  return write((uint8_t)c);
+}
+
+static size_t printNumber(Print &p, unsigned long n, int base) {
+  char buffer[8 * sizeof (long) + 1];
+  char *s = &buffer[sizeof (buffer) - 1];
+  *s = '\0';
+  if (base < 2)
+    base = 10;
+  do {
+    int digit = n % base;
+    n /= base;
+    *--s = (digit < 10) ? '0' + digit : 'A' + digit - 10;
+  } while (n);
+  return p.write(s);
+}
+
+size_t Print::print(unsigned char n, int base) {
+  return printNumber(*this, n, base);
+}
+
+size_t Print::print(int n, int base) {
+  return print((long)n, base);
+}
+
+size_t Print::print(unsigned int n, int base) {
+  return printNumber(*this, n, base);
+}
+
+size_t Print::print(long n, int base) {
+  if ((base == 10) && (n < 0))
+    return print('-') + printNumber(*this, -(unsigned long)n, 10);
+  return printNumber(*this, n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  return printNumber(*this, n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buffer[32];
+  snprintf(buffer, sizeof (buffer), "%.*f", digits, n);
+  return write(buffer);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = read();
+    if (c < 0) {
+      // Stream waits out its timeout for the rest
+      simAdvance(1000000UL);
+      break;
+    }
+    buffer[count++] = c;
+  }
+  return count;
+}
+
+Serial_ Serial;
+
+int Serial_::available() {
+  return serialInput.size();
+}
+
+int Serial_::read() {
+  if (serialInput.empty()) {
+    simAdvance(SIM_SERIAL_POLL_MICROS);
+    return -1;
+  }
+  uint8_t c = serialInput.front();
+  serialInput.pop_front();
+  return c;
+}
+
+int Serial_::peek() {
+  return serialInput.empty() ? -1 : serialInput.front();
+}
+
+size_t Serial_::write(uint8_t c) {
+  simSerialOutput += (char)c;
+  return 1;
+}
+
+// avr-libc
+
+uint8_t eeprom_read_byte(const uint8_t *address) {
+  return simEeprom[(uintptr_t)address];
+}
+
+void eeprom_update_byte(uint8_t *address, uint8_t value) {
+  if (simEeprom[(uintptr_t)address] == value)
+    return;
+  simEeprom[(uintptr_t)address] = value;
+  simEepromWrites++;
+}
+
+void eeprom_read_block(void *dest, const void *source, size_t size) {
+  memcpy(dest, &simEeprom[(uintptr_t)source], size);
+}
+
+// libraries
+
+TwoWire Wire;
+
+HID_ &HID() {
+  static HID_ hid;
+  return hid;
+}
+
+/* Each interrupt endpoint holds a single report until the host polls it at
+   the next frame. Returns when the report will be polled. */
+static unsigned long sendOnEndpoint(uint8_t ep, uint8_t id, const void *data, int len) {
+  ep &= 0x0F;
+  if (simMicros < usbEndpointFreeAt[ep])
+    simAdvance(usbEndpointFreeAt[ep] - simMicros);
+  unsigned long polledAt = (simMicros / SIM_USB_FRAME_MICROS + 1) * SIM_USB_FRAME_MICROS;
+  usbEndpointFreeAt[ep] = polledAt;
+
+  simHidReport report;
+  report.time = polledAt;
+  report.endpoint = ep;
+  report.id = id;
+  report.data.assign((const uint8_t *)data, (const uint8_t *)data + len);
+  simHidReports.push_back(report);
+  return polledAt;
+}
+
+// The HID-Project devices share the core's HID() endpoint
+int HID_::SendReport(uint8_t id, const void *data, int len) {
+  sendOnEndpoint(SIM_HID_ENDPOINT, id, data, len);
+  return len + 1;
+}
+
+void HID_::AppendDescriptor(HIDSubDescriptor *node) {
+  if (!rootNode) {
+    rootNode = node;
+    return;
+  }
+  HIDSubDescriptor *current = rootNode;
+  while (current->next) {
+    current = current->next;
+  }
+  current->next = node;
+}
+
+int USB_Send(uint8_t ep, const void *data, int len) {
+  sendOnEndpoint(ep, 0, data, len);
+  return len;
+}
+
+int USB_SendControl(uint8_t flags, const void *data, int len) {
+  simControlReply.insert(simControlReply.end(), (const uint8_t *)data, (const uint8_t *)data + len);
+  return len;
+}
+
+int USB_RecvControl(void *data, int len) {
+  int received = 0;
+  while ((received < len) && !controlData.empty()) {
+    ((uint8_t *)data)[received++] = controlData.front();
+    controlData.pop_front();
+  }
+  return received;
+}
+
+PluggableUSB_ &PluggableUSB() {
+  static PluggableUSB_ pluggableUSB;
+  return pluggableUSB;
+}
+
+bool PluggableUSB_::plug(PluggableUSBModule *node) {
+  node->pluggedInterface = lastIf;
+  node->pluggedEndpoint = lastEp;
+  lastIf += node->numInterfaces;
+  lastEp += node->numEndpoints;
+
+  if (!rootNode) {
+    rootNode = node;
+    return true;
+  }
+  PluggableUSBModule *current = rootNode;
+  while (current->next) {
+    current = current->next;
+  }
+  current->next = node;
+  return true;
+}
+
+int PluggableUSB_::getInterface(uint8_t *interfaceCount) {
+  int sent = 0;
+  for (PluggableUSBModule *node = rootNode; node; node = node->next) {
+    int result = node->getInterface(interfaceCount);
+    if (result < 0)
+      return -1;
+    sent += result;
+  }
+  return sent;
+}
+
+int PluggableUSB_::getDescriptor(USBSetup &setup) {
+  for (PluggableUSBModule *node = rootNode; node; node = node->next) {
+    int result = node->getDescriptor(setup);
+    if (result)
+      return result;
+  }
+  return 0;
+}
+
+bool PluggableUSB_::setup(USBSetup &setup) {
+  for (PluggableUSBModule *node = rootNode; node; node = node->next) {
+    if (node->setup(setup))
+      return true;
+  }
+  return false;
+}
+
+bool simControlRequest(uint8_t requestType, uint8_t request, uint16_t value, uint16_t index,
+                       const uint8_t *data, uint16_t length) {
+  USBSetup setup = {requestType, request, lowByte(value), highByte(value), index, length};
+  controlData.assign(data, data + length);
+  simControlReply.clear();
+  if ((requestType == REQUEST_DEVICETOHOST_STANDARD_INTERFACE) && (request == 6)) // GET_DESCRIPTOR
+    return PluggableUSB().getDescriptor(setup) > 0;
+  return PluggableUSB().setup(setup);
+}
+
+Keyboard_ Keyboard;
+Consumer_ Consumer;
+Mouse_ Mouse;
+
+void simDisplayByte() {
+  simDisplayBytes++;
+  simAdvance(SIM_DISPLAY_BYTE_MICROS);
+}
+
+static const uint8_t adafruit128x64Init[] = {
+  0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x02,
+  0xA1, 0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6,
+  0xAF
+};
+
+const DevType Adafruit128x64 = {
+  adafruit128x64Init, sizeof (adafruit128x64Init), 128, 64, 0
+};
+
+// Arial14's header and character widths; the glyphs themselves aren't needed
+const uint8_t Arial14[] = {
+  0x1E, 0x6C, 0x0D, 0x0E, 0x20, 0x60,
+  0x03, 0x02, 0x03, 0x08, 0x07, 0x0A, 0x08, 0x01, 0x03, 0x03, 0x05, 0x07, 0x02, 0x04, 0x02, 0x04,
+  0x07, 0x04, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x07, 0x02, 0x02, 0x06, 0x06, 0x06, 0x07,
+  0x0D, 0x09, 0x08, 0x09, 0x09, 0x08, 0x07, 0x09, 0x08, 0x02, 0x06, 0x09, 0x07, 0x0A, 0x08, 0x09,
+  0x08, 0x09, 0x09, 0x08, 0x08, 0x08, 0x09, 0x0D, 0x08, 0x0A, 0x08, 0x03, 0x04, 0x03, 0x05, 0x08,
+  0x03, 0x07, 0x07, 0x06, 0x07, 0x07, 0x04, 0x07, 0x06, 0x02, 0x03, 0x06, 0x02, 0x0A, 0x06, 0x07,
+  0x07, 0x07, 0x04, 0x06, 0x04, 0x06, 0x07, 0x09, 0x06, 0x07, 0x06, 0x04, 0x01, 0x04, 0x07, 0x00
+};
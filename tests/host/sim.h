@@ -0,0 +1,91 @@
+#ifndef SIM_H
+#define SIM_H
+
+/*
+The simulated board behind the stand-in headers in stubs/, for running the
+sketch on a desktop machine (see the Makefile).
+
+Time only moves when something takes time: delay(), bytes sent to the
+display (at I2C speed), HID reports waiting for the host to poll the
+endpoint, SIM_LOOP_MICROS of overhead per loop() run through simLoop(), and
+simAdvance() itself. Pin changes can be scheduled ahead; they happen as time
+passes over them, in the middle of whatever is taking the time, the way an
+interrupt would, and call simPinChangeHandler.
+*/
+
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "avr/eeprom.h"
+
+// cost of one trip round loop() besides what is simulated; microseconds
+#define SIM_LOOP_MICROS 20
+
+// one byte to the display at 100kHz, 9 bits with the acknowledge
+#define SIM_DISPLAY_BYTE_MICROS 90
+
+// the host polls the HID endpoint once per USB frame
+#define SIM_USB_FRAME_MICROS 1000
+
+// endpoint of the HID() reports; PluggableUSB modules get the ones after it
+#define SIM_HID_ENDPOINT 4
+
+// Serial.read() finding nothing, as in a busy-wait
+#define SIM_SERIAL_POLL_MICROS 2
+
+#define SIM_PINS 32
+
+extern unsigned long simMicros;
+
+// Back to power-on: time 0, every pin high, EEPROM erased, the logs empty
+void simReset();
+
+// Move time on, making the scheduled pin changes on the way
+void simAdvance(unsigned long micros);
+
+void simSetPin(uint8_t pin, uint8_t level);
+void simSchedulePin(unsigned long at, uint8_t pin, uint8_t level);
+uint8_t simPinLevel(uint8_t pin);
+
+// called after a pin changes, as a pin-change interrupt would be
+extern void (*simPinChangeHandler)(uint8_t pin);
+
+// run loop() once; returns the simulated microseconds it took
+unsigned long simLoop();
+
+// run loop() until the given time
+void simRunUntil(unsigned long micros);
+
+// bytes from the host, for the sketch to read from Serial
+void simSerialSend(const char *text);
+void simSerialSend(const uint8_t *data, size_t length);
+
+// what the sketch wrote to Serial
+extern std::string simSerialOutput;
+
+extern uint8_t simEeprom[E2END + 1];
+extern unsigned long simEepromWrites; // bytes actually changed
+
+struct simHidReport {
+  unsigned long time; // when the host polled it from the endpoint
+  uint8_t endpoint; // SIM_HID_ENDPOINT, or a PluggableUSB module's
+  uint8_t id; // for SIM_HID_ENDPOINT; 0 otherwise
+  std::vector<uint8_t> data;
+};
+
+extern std::vector<simHidReport> simHidReports;
+
+/* A control request from the host, handled by the PluggableUSB modules as
+   during enumeration; `data` is the data stage of a request that sends one.
+   Returns whether a module accepted it; what it sent back is in
+   simControlReply. */
+bool simControlRequest(uint8_t requestType, uint8_t request, uint16_t value, uint16_t index,
+                       const uint8_t *data = NULL, uint16_t length = 0);
+
+// what USB_SendControl() sent since it was last cleared
+extern std::vector<uint8_t> simControlReply;
+
+extern unsigned long simDisplayBytes;
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+/* The whole sketch, compiled into the test or benchmark that includes this,
+   with the parts of the board the simulation (sim.h) doesn't know about:
+   the encoder's interrupt, and scripted presses and wheel turns */
+
+#include "sim.h"
+#include "scroll_wheel_controller.ino"
+
+// what PCINT0_vect does (encoder.h)
+void simEncoderInterrupt(uint8_t pin) {
+  if ((pin == ENC_PIN_A) || (pin == ENC_PIN_B))
+    decodeEncoder(readEncoderPins());
+}
+
+// Reset the simulation and run setup()
+void simPowerOn() {
+  simReset();
+  simPinChangeHandler = simEncoderInterrupt;
+  setup();
+}
+
+// pins of each BUTTON_*
+const uint8_t simButtonPins[NUMBER_OF_BUTTONS] = {
+  MIDDLE_PIN, UP_PIN, DOWN_PIN, LEFT_PIN, RIGHT_PIN
+};
+
+/* Press a button at `at` and release it `length` microseconds later. Each
+   edge bounces `bounces` times, 100us apart, before it settles. */
+void simSchedulePress(unsigned long at, uint8_t button, unsigned long length, uint8_t bounces = 0) {
+  uint8_t pin = simButtonPins[button];
+  for (uint8_t i = 0; i < bounces; i++) {
+    simSchedulePin(at + 200 * i, pin, LOW);
+    simSchedulePin(at + 200 * i + 100, pin, HIGH);
+    simSchedulePin(at + length + 200 * i, pin, HIGH);
+    simSchedulePin(at + length + 200 * i + 100, pin, LOW);
+  }
+  simSchedulePin(at + 200 * bounces, pin, LOW);
+  simSchedulePin(at + length + 200 * bounces, pin, HIGH);
+}
+
+// the encoder state (B << 1) | A the scheduled turns leave the wheel in
+uint8_t simEncoderState = ENCODER_REST_STATE;
+
+// encoder states in the order turning CW goes through them
+const uint8_t simEncoderSequence[4] = {0b11, 0b01, 0b00, 0b10};
+
+/* Turn the wheel by `detents` detents (negative is CCW), the first starting
+   at `at` and one every `interval` microseconds, the transitions of each
+   spread evenly over its interval */
+void simScheduleDetents(unsigned long at, int detents, unsigned long interval) {
+  uint8_t position = 0;
+  while (simEncoderSequence[position] != simEncoderState) {
+    position++;
+  }
+
+  int8_t direction = (detents < 0) ? -1 : 1;
+  for (int d = 0; d < abs(detents); d++) {
+    for (uint8_t s = 0; s < ENCODER_STEPS_PER_DETENT; s++) {
+      position = (position + 4 + direction) % 4;
+      uint8_t state = simEncoderSequence[position];
+      unsigned long time = at + d * interval + s * interval / ENCODER_STEPS_PER_DETENT;
+      if ((state ^ simEncoderState) & 0b01)
+        simSchedulePin(time, ENC_PIN_A, state & 0b01);
+      if ((state ^ simEncoderState) & 0b10)
+        simSchedulePin(time, ENC_PIN_B, state >> 1);
+      simEncoderState = state;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef HID_PROJECT_H
+#define HID_PROJECT_H
+
+/* Stand-in for NicoHood's HID-Project: the keyboard, consumer and mouse
+   devices the sketch uses, sending their reports through the stand-in HID()
+   with the same report IDs and layouts */
+
+#include "Arduino.h"
+#include "HID.h"
+
+#define HID_REPORTID_MOUSE 1
+#define HID_REPORTID_KEYBOARD 2
+#define HID_REPORTID_RAWHID 3
+#define HID_REPORTID_CONSUMERCONTROL 4
+#define HID_REPORTID_SYSTEMCONTROL 5
+#define HID_REPORTID_GAMEPAD 6
+#define HID_REPORTID_MOUSE_ABSOLUTE 7
+#define HID_REPORTID_NKRO_KEYBOARD 8
+#define HID_REPORTID_TEENSY_KEYBOARD 9
+#define HID_REPORTID_SURFACEDIAL 10
+
+#define HID_REPORT_TYPE_INPUT 1
+#define HID_REPORT_TYPE_OUTPUT 2
+#define HID_REPORT_TYPE_FEATURE 3
+
+// HID usage IDs, keyboard/keypad page
+enum KeyboardKeycode : uint8_t {
+  KEY_RESERVED = 0,
+  KEY_A = 4, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I, KEY_J,
+  KEY_K, KEY_L, KEY_M, KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S, KEY_T,
+  KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z,
+  KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9, KEY_0,
+  KEY_ENTER = 0x28,
+  KEY_ESC = 0x29,
+  KEY_BACKSPACE = 0x2A,
+  KEY_TAB = 0x2B,
+  KEY_SPACE = 0x2C,
+  KEY_MINUS = 0x2D,
+  KEY_EQUAL = 0x2E,
+  KEY_LEFT_BRACE = 0x2F,
+  KEY_RIGHT_BRACE = 0x30,
+  KEY_BACKSLASH = 0x31,
+  KEY_SEMICOLON = 0x33,
+  KEY_QUOTE = 0x34,
+  KEY_TILDE = 0x35,
+  KEY_COMMA = 0x36,
+  KEY_PERIOD = 0x37,
+  KEY_SLASH = 0x38,
+  KEY_CAPS_LOCK = 0x39,
+  KEY_F1 = 0x3A, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8,
+  KEY_F9, KEY_F10, KEY_F11, KEY_F12,
+  KEY_PRINTSCREEN = 0x46,
+  KEY_SCROLL_LOCK = 0x47,
+  KEY_PAUSE = 0x48,
+  KEY_INSERT = 0x49,
+  KEY_HOME = 0x4A,
+  KEY_PAGE_UP = 0x4B,
+  KEY_DELETE = 0x4C,
+  KEY_END = 0x4D,
+  KEY_PAGE_DOWN = 0x4E,
+  KEY_RIGHT_ARROW = 0x4F,
+  KEY_LEFT_ARROW = 0x50,
+  KEY_DOWN_ARROW = 0x51,
+  KEY_UP_ARROW = 0x52,
+  KEY_LEFT_CTRL = 0xE0,
+  KEY_LEFT_SHIFT = 0xE1,
+  KEY_LEFT_ALT = 0xE2,
+  KEY_LEFT_GUI = 0xE3,
+  KEY_RIGHT_CTRL = 0xE4,
+  KEY_RIGHT_SHIFT = 0xE5,
+  KEY_RIGHT_ALT = 0xE6,
+  KEY_RIGHT_GUI = 0xE7
+};
+
+// HID usage IDs, consumer page
+enum ConsumerKeycode : uint16_t {
+  CONSUMER_BRIGHTNESS_UP = 0x6F,
+  CONSUMER_BRIGHTNESS_DOWN = 0x70,
+  MEDIA_FAST_FORWARD = 0xB3,
+  MEDIA_REWIND = 0xB4,
+  MEDIA_NEXT = 0xB5,
+  MEDIA_PREVIOUS = 0xB6,
+  MEDIA_STOP = 0xB7,
+  MEDIA_PLAY_PAUSE = 0xCD,
+  MEDIA_VOLUME_MUTE = 0xE2,
+  MEDIA_VOLUME_UP = 0xE9,
+  MEDIA_VOLUME_DOWN = 0xEA,
+  CONSUMER_EMAIL_READER = 0x18A,
+  CONSUMER_CALCULATOR = 0x192,
+  CONSUMER_EXPLORER = 0x194,
+  CONSUMER_BROWSER_HOME = 0x223,
+  CONSUMER_BROWSER_BACK = 0x224,
+  CONSUMER_BROWSER_FORWARD = 0x225,
+  CONSUMER_BROWSER_REFRESH = 0x227,
+  CONSUMER_BROWSER_BOOKMARKS = 0x22A,
+
+  HID_CONSUMER_SCAN_NEXT_TRACK = 0xB5,
+  HID_CONSUMER_SCAN_PREVIOUS_TRACK = 0xB6
+};
+
+#define MOUSE_LEFT (1 << 0)
+#define MOUSE_RIGHT (1 << 1)
+#define MOUSE_MIDDLE (1 << 2)
+
+union HID_ConsumerControlReport_Data_t {
+  uint16_t keys[4];
+  struct {
+    uint16_t key1;
+    uint16_t key2;
+    uint16_t key3;
+    uint16_t key4;
+  };
+};
+
+union HID_KeyboardReport_Data_t {
+  uint8_t whole8[8];
+  struct {
+    uint8_t modifiers;
+    uint8_t reserved;
+    uint8_t keys[6];
+  };
+};
+
+union HID_MouseReport_Data_t {
+  uint8_t whole8[4];
+  struct {
+    uint8_t buttons;
+    int8_t xAxis;
+    int8_t yAxis;
+    int8_t wheel;
+  };
+};
+
+class Keyboard_ {
+public:
+  void begin() { releaseAll(); }
+  void end() { releaseAll(); }
+
+  // the same as HID-Project's: modifiers go in the bitmap, other keys in a free slot
+  size_t add(KeyboardKeycode k) {
+    if ((k >= KEY_LEFT_CTRL) && (k <= KEY_RIGHT_GUI)) {
+      report.modifiers |= 1 << (k - KEY_LEFT_CTRL);
+      return 1;
+    }
+    for (uint8_t i = 0; i < sizeof (report.keys); i++) {
+      if (report.keys[i] == k)
+        return 1;
+    }
+    for (uint8_t i = 0; i < sizeof (report.keys); i++) {
+      if (report.keys[i] == KEY_RESERVED) {
+        report.keys[i] = k;
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  size_t remove(KeyboardKeycode k) {
+    if ((k >= KEY_LEFT_CTRL) && (k <= KEY_RIGHT_GUI)) {
+      report.modifiers &= ~(1 << (k - KEY_LEFT_CTRL));
+      return 1;
+    }
+    for (uint8_t i = 0; i < sizeof (report.keys); i++) {
+      if (report.keys[i] == k) {
+        report.keys[i] = KEY_RESERVED;
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  size_t removeAll() {
+    memset(&report, 0, sizeof (report));
+    return 1;
+  }
+
+  int send() { return HID().SendReport(HID_REPORTID_KEYBOARD, &report, sizeof (report)); }
+
+  size_t press(KeyboardKeycode k) { size_t n = add(k); send(); return n; }
+  size_t release(KeyboardKeycode k) { size_t n = remove(k); send(); return n; }
+  size_t releaseAll() { removeAll(); send(); return 1; }
+
+  HID_KeyboardReport_Data_t report = {};
+};
+
+class Consumer_ {
+public:
+  void begin() { releaseAll(); }
+  void end() { releaseAll(); }
+
+  void write(ConsumerKeycode m) { press(m); release(m); }
+
+  void press(ConsumerKeycode m) {
+    for (uint8_t i = 0; i < 4; i++) {
+      if (report.keys[i] == 0) {
+        report.keys[i] = m;
+        break;
+      }
+    }
+    send();
+  }
+
+  void release(ConsumerKeycode m) {
+    for (uint8_t i = 0; i < 4; i++) {
+      if (report.keys[i] == m)
+        report.keys[i] = 0;
+    }
+    send();
+  }
+
+  void releaseAll() {
+    memset(&report, 0, sizeof (report));
+    send();
+  }
+
+  void send() { HID().SendReport(HID_REPORTID_CONSUMERCONTROL, &report, sizeof (report)); }
+
+  HID_ConsumerControlReport_Data_t report = {};
+};
+
+class Mouse_ {
+public:
+  void begin() { buttons = 0; }
+  void end() {}
+
+  void click(uint8_t b = MOUSE_LEFT) {
+    buttons = b;
+    move(0, 0, 0);
+    buttons = 0;
+    move(0, 0, 0);
+  }
+
+  void move(signed char x, signed char y, signed char wheel = 0) {
+    HID_MouseReport_Data_t report;
+    report.buttons = buttons;
+    report.xAxis = x;
+    report.yAxis = y;
+    report.wheel = wheel;
+    HID().SendReport(HID_REPORTID_MOUSE, &report, sizeof (report));
+  }
+
+  void press(uint8_t b = MOUSE_LEFT) { buttons |= b; move(0, 0, 0); }
+  void release(uint8_t b = MOUSE_LEFT) { buttons &= ~b; move(0, 0, 0); }
+  bool isPressed(uint8_t b = MOUSE_LEFT) { return buttons & b; }
+
+  uint8_t buttons = 0;
+};
+
+extern Keyboard_ Keyboard;
+extern Consumer_ Consumer;
+extern Mouse_ Mouse;
+
+#endif
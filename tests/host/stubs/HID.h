@@ -0,0 +1,64 @@
+#ifndef HID_H
+#define HID_H
+
+/* Stand-in for the HID library of the Arduino AVR core: reports are logged
+   by the simulation (simHidReports in sim.h) instead of going over USB */
+
+#include "Arduino.h"
+#include "PluggableUSB.h"
+
+#define HID_GET_REPORT 0x01
+#define HID_GET_IDLE 0x02
+#define HID_GET_PROTOCOL 0x03
+#define HID_SET_REPORT 0x09
+#define HID_SET_IDLE 0x0A
+#define HID_SET_PROTOCOL 0x0B
+
+#define HID_HID_DESCRIPTOR_TYPE 0x21
+#define HID_REPORT_DESCRIPTOR_TYPE 0x22
+
+#define HID_SUBCLASS_NONE 0
+#define HID_PROTOCOL_NONE 0
+#define HID_BOOT_PROTOCOL 0
+#define HID_REPORT_PROTOCOL 1
+
+typedef struct __attribute__((packed)) {
+  uint8_t len; // 9
+  uint8_t dtype; // 0x21
+  uint8_t addr;
+  uint8_t versionL; // 0x101
+  uint8_t versionH; // 0x101
+  uint8_t country;
+  uint8_t desctype; // 0x22 report
+  uint8_t descLenL;
+  uint8_t descLenH;
+} HIDDescDescriptor;
+
+typedef struct __attribute__((packed)) {
+  InterfaceDescriptor hid;
+  HIDDescDescriptor desc;
+  EndpointDescriptor in;
+} HIDDescriptor;
+
+#define D_HIDREPORT(length) { 9, 0x21, 0x01, 0x01, 0, 1, 0x22, lowByte(length), highByte(length) }
+
+class HIDSubDescriptor {
+public:
+  HIDSubDescriptor(const void *d, const uint16_t l) : data(d), length(l) {}
+
+  HIDSubDescriptor *next = NULL;
+  const void *data;
+  const uint16_t length;
+};
+
+class HID_ {
+public:
+  int SendReport(uint8_t id, const void *data, int len);
+  void AppendDescriptor(HIDSubDescriptor *node);
+
+  HIDSubDescriptor *rootNode = NULL;
+};
+
+HID_ &HID();
+
+#endif
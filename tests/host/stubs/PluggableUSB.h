@@ -0,0 +1,104 @@
+#ifndef PLUGGABLE_USB_H
+#define PLUGGABLE_USB_H
+
+/* Stand-in for PluggableUSB and the USB core of the Arduino AVR core, with
+   the definitions from USBCore.h and USBAPI.h that modules use. The host's
+   control requests come from simControlRequest() and what goes back is
+   logged by the simulation (sim.h) instead of going over USB. */
+
+#include "Arduino.h"
+
+typedef struct {
+  uint8_t bmRequestType;
+  uint8_t bRequest;
+  uint8_t wValueL;
+  uint8_t wValueH;
+  uint16_t wIndex;
+  uint16_t wLength;
+} USBSetup;
+
+#define REQUEST_DEVICETOHOST_CLASS_INTERFACE 0xA1
+#define REQUEST_HOSTTODEVICE_CLASS_INTERFACE 0x21
+#define REQUEST_DEVICETOHOST_STANDARD_INTERFACE 0x81
+
+#define USB_DEVICE_CLASS_HUMAN_INTERFACE 0x03
+#define USB_ENDPOINT_TYPE_INTERRUPT 0x03
+#define USB_ENDPOINT_IN(addr) (lowByte((addr) | 0x80))
+#define USB_EP_SIZE 64
+
+#define EP_TYPE_INTERRUPT_IN 0xC1
+#define EPTYPE_DESCRIPTOR_SIZE uint8_t
+
+#define TRANSFER_PGM 0x80
+#define TRANSFER_RELEASE 0x40
+#define TRANSFER_ZERO 0x20
+
+typedef struct __attribute__((packed)) {
+  uint8_t len; // 9
+  uint8_t dtype; // 4
+  uint8_t number;
+  uint8_t alternate;
+  uint8_t numEndpoints;
+  uint8_t interfaceClass;
+  uint8_t interfaceSubClass;
+  uint8_t protocol;
+  uint8_t iInterface;
+} InterfaceDescriptor;
+
+typedef struct __attribute__((packed)) {
+  uint8_t len; // 7
+  uint8_t dtype; // 5
+  uint8_t addr;
+  uint8_t attr;
+  uint16_t packetSize;
+  uint8_t interval;
+} EndpointDescriptor;
+
+#define D_INTERFACE(_n, _numEndpoints, _class, _subClass, _protocol) \
+  { 9, 4, _n, 0, _numEndpoints, _class, _subClass, _protocol, 0 }
+
+#define D_ENDPOINT(_addr, _attr, _packetSize, _interval) \
+  { 7, 5, _addr, _attr, _packetSize, _interval }
+
+int USB_SendControl(uint8_t flags, const void *data, int len);
+int USB_RecvControl(void *data, int len);
+int USB_Send(uint8_t ep, const void *data, int len);
+
+class PluggableUSBModule {
+public:
+  PluggableUSBModule(uint8_t numEps, uint8_t numIfs, EPTYPE_DESCRIPTOR_SIZE *epType)
+    : numEndpoints(numEps), numInterfaces(numIfs), endpointType(epType) {}
+
+protected:
+  virtual bool setup(USBSetup &setup) = 0;
+  virtual int getInterface(uint8_t *interfaceCount) = 0;
+  virtual int getDescriptor(USBSetup &setup) = 0;
+
+  uint8_t pluggedInterface = 0;
+  uint8_t pluggedEndpoint = 0;
+
+  const uint8_t numEndpoints;
+  const uint8_t numInterfaces;
+  const EPTYPE_DESCRIPTOR_SIZE *endpointType;
+
+  PluggableUSBModule *next = NULL;
+
+  friend class PluggableUSB_;
+};
+
+class PluggableUSB_ {
+public:
+  bool plug(PluggableUSBModule *node);
+  int getInterface(uint8_t *interfaceCount);
+  int getDescriptor(USBSetup &setup);
+  bool setup(USBSetup &setup);
+
+private:
+  uint8_t lastIf = 3; // after the serial port's two interfaces and HID's
+  uint8_t lastEp = 5; // after theirs
+  PluggableUSBModule *rootNode = NULL;
+};
+
+PluggableUSB_ &PluggableUSB();
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef SSD1306ASCII_H
+#define SSD1306ASCII_H
+
+/* Stand-in for greiman's SSD1306Ascii. Fonts are measured the way the
+   library does, from the font header, but nothing is drawn: the bytes that
+   would go to the display are counted (simDisplayBytes in sim.h), and each
+   one takes simulated time as if sent over I2C. */
+
+#include "Arduino.h"
+
+#define GLCDFONTDECL(_n) const uint8_t _n[] PROGMEM
+
+// font header: uint16 size, width, height, first char, char count, then widths if proportional
+#define FONT_LENGTH 0
+#define FONT_WIDTH 2
+#define FONT_HEIGHT 3
+#define FONT_FIRST_CHAR 4
+#define FONT_CHAR_COUNT 5
+#define FONT_WIDTH_TABLE 6
+
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+#define SSD1306_SETCONTRAST 0x81
+
+struct DevType {
+  const uint8_t *initcmds;
+  uint8_t initSize;
+  uint8_t lcdWidth;
+  uint8_t lcdHeight;
+  uint8_t colOffset;
+};
+
+extern const DevType Adafruit128x64;
+extern const uint8_t Arial14[];
+
+// counts a byte sent to the display; see sim.cpp
+void simDisplayByte();
+
+class SSD1306Ascii : public Print {
+public:
+  void clear() { clear(0, displayWidth() - 1, 0, displayRows() - 1); }
+
+  void clear(uint8_t c0, uint8_t c1, uint8_t r0, uint8_t r1) {
+    for (uint8_t r = r0; r <= r1; r++) {
+      setCursor(c0, r);
+      for (uint8_t c = c0; c <= c1; c++) {
+        ssd1306WriteRam(0);
+      }
+    }
+    setCursor(c0, r0);
+  }
+
+  void clearField(uint8_t col, uint8_t row, uint8_t n) {
+    clear(col, col + n * (fontWidth() + letterSpacing()) - 1, row, row + fontRows() - 1);
+  }
+
+  void setCursor(uint8_t c, uint8_t r) {
+    m_col = c;
+    m_row = r;
+    ssd1306WriteCmd(0xB0 | r);
+    ssd1306WriteCmd(c & 0x0F);
+    ssd1306WriteCmd(0x10 | (c >> 4));
+  }
+
+  uint8_t col() const { return m_col; }
+  uint8_t row() const { return m_row; }
+
+  void setFont(const uint8_t *font) {
+    m_font = font;
+    m_letterSpacing = (font && (fontSize() == 1)) ? 0 : 1;
+  }
+  const uint8_t *font() const { return m_font; }
+
+  uint16_t fontSize() const { return pgm_read_byte(m_font + FONT_LENGTH) << 8 | pgm_read_byte(m_font + FONT_LENGTH + 1); }
+  uint8_t fontWidth() const { return m_font ? pgm_read_byte(m_font + FONT_WIDTH) : 0; }
+  uint8_t fontHeight() const { return m_font ? pgm_read_byte(m_font + FONT_HEIGHT) : 0; }
+  uint8_t fontRows() const { return m_font ? (fontHeight() + 7) / 8 : 1; }
+  uint8_t letterSpacing() const { return m_letterSpacing; }
+  void setLetterSpacing(uint8_t spacing) { m_letterSpacing = spacing; }
+
+  uint8_t charWidth(uint8_t c) const {
+    if (!m_font)
+      return 0;
+    uint8_t first = pgm_read_byte(m_font + FONT_FIRST_CHAR);
+    uint8_t count = pgm_read_byte(m_font + FONT_CHAR_COUNT);
+    if ((c < first) || (c >= first + count))
+      return 0;
+    if (fontSize() < 2)
+      return fontWidth();
+    return pgm_read_byte(m_font + FONT_WIDTH_TABLE + c - first);
+  }
+
+  size_t strWidth(const char *str) const {
+    size_t width = 0;
+    while (*str) {
+      width += charWidth(*str++) + letterSpacing();
+    }
+    return width;
+  }
+
+  uint8_t displayWidth() const { return m_device ? m_device->lcdWidth : 128; }
+  uint8_t displayHeight() const { return m_device ? m_device->lcdHeight : 64; }
+  uint8_t displayRows() const { return displayHeight() / 8; }
+
+  void setContrast(uint8_t value) {
+    ssd1306WriteCmd(SSD1306_SETCONTRAST);
+    ssd1306WriteCmd(value);
+  }
+
+  // like the library: a newline moves down by the font's rows, everything else is drawn
+  size_t write(uint8_t c) override {
+    if (!m_font)
+      return 0;
+    if (c == '\r')
+      return 1;
+    if (c == '\n') {
+      setCursor(0, m_row + fontRows());
+      return 1;
+    }
+    uint8_t w = charWidth(c);
+    if (w == 0)
+      return 0;
+    uint8_t col0 = m_col;
+    uint8_t row0 = m_row;
+    for (uint8_t r = 0; r < fontRows(); r++) {
+      if (r > 0)
+        setCursor(col0, row0 + r);
+      for (uint8_t i = 0; i < w + letterSpacing(); i++) {
+        ssd1306WriteRam(0);
+      }
+    }
+    if (fontRows() > 1)
+      setCursor(col0 + w + letterSpacing(), row0);
+    return 1;
+  }
+  using Print::write;
+
+  void ssd1306WriteCmd(uint8_t) { simDisplayByte(); }
+  void ssd1306WriteRam(uint8_t) { simDisplayByte(); m_col++; }
+
+protected:
+  const DevType *m_device = NULL;
+  const uint8_t *m_font = NULL;
+  uint8_t m_col = 0;
+  uint8_t m_row = 0;
+  uint8_t m_letterSpacing = 1;
+};
+
+#endif
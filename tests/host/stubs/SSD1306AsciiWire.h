@@ -0,0 +1,27 @@
+#ifndef SSD1306ASCIIWIRE_H
+#define SSD1306ASCIIWIRE_H
+
+// Stand-in for greiman's SSD1306AsciiWire; see SSD1306Ascii.h
+
+#include "SSD1306Ascii.h"
+#include "Wire.h"
+
+class SSD1306AsciiWire : public SSD1306Ascii {
+public:
+  void begin(const DevType *device, uint8_t i2cAddr, int8_t rst = -1) {
+    m_device = device;
+    m_i2cAddr = i2cAddr;
+    m_col = 0;
+    m_row = 0;
+    for (uint8_t i = 0; i < device->initSize; i++) {
+      ssd1306WriteCmd(pgm_read_byte(device->initcmds + i));
+    }
+  }
+
+  void setI2cClock(uint32_t frequency) {}
+
+private:
+  uint8_t m_i2cAddr = 0;
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+// Stand-in for the Arduino Wire library; the display is simulated instead
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+  void begin() {}
+  void setClock(uint32_t clock) {}
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef AVR_EEPROM_H
+#define AVR_EEPROM_H
+
+/* Stand-in for avr-libc, over the simulated EEPROM (simEeprom in sim.h).
+   Writes complete at once. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define E2END 0x3FF
+
+uint8_t eeprom_read_byte(const uint8_t *address);
+void eeprom_update_byte(uint8_t *address, uint8_t value);
+void eeprom_read_block(void *dest, const void *source, size_t size);
+#define eeprom_is_ready() true
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef AVR_INTERRUPT_H
+#define AVR_INTERRUPT_H
+
+// Stand-in for avr-libc; the simulation has no interrupts
+
+#define ISR(vector) extern "C" void vector(void)
+#define sei()
+#define cli()
+
+#endif
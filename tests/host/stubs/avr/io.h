@@ -0,0 +1,25 @@
+#ifndef AVR_IO_H
+#define AVR_IO_H
+
+/* Stand-in for avr-libc: the ATmega32u4 registers the sketch touches, as
+   plain variables (defined in sim.cpp) */
+
+#include <stdint.h>
+
+extern volatile uint8_t PINB, PINC, PIND, PINE, PINF;
+extern volatile uint8_t PCICR, PCMSK0, PCIFR;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+extern volatile uint16_t TCNT1;
+extern volatile uint8_t ADCSRA;
+
+#define PCIE0 0
+#define PCINT4 4
+#define PCINT5 5
+#define PCINT6 6
+#define CS10 0
+#define TOV1 0
+#define TOIE1 0
+
+#define _BV(bit) (1 << (bit))
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef AVR_POWER_H
+#define AVR_POWER_H
+
+// Stand-in for avr-libc
+
+#define power_adc_disable()
+#define power_spi_disable()
+#define power_usart1_disable()
+
+#endif
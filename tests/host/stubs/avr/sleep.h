@@ -0,0 +1,12 @@
+#ifndef AVR_SLEEP_H
+#define AVR_SLEEP_H
+
+// Stand-in for avr-libc; power.h doesn't sleep in HOST_SIMULATION builds
+
+#define SLEEP_MODE_IDLE 0
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()
+
+#endif
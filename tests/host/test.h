@@ -0,0 +1,67 @@
+#ifndef TEST_H
+#define TEST_H
+
+/* A minimal test runner: TEST(name) { ... } defines a test case, CHECK()
+   and CHECK_EQUAL() report failures without stopping it. main() runs every
+   test case in the file in order and fails if any check did. */
+
+#include <stdio.h>
+
+typedef void (*testFunction)();
+
+struct testCase {
+  const char *name;
+  testFunction function;
+};
+
+static testCase testCases[64];
+static int testCaseCount = 0;
+static int testFailures = 0;
+
+struct testRegistration {
+  testRegistration(const char *name, testFunction function) {
+    testCases[testCaseCount].name = name;
+    testCases[testCaseCount].function = function;
+    testCaseCount++;
+  }
+};
+
+#define TEST(name) \
+  static void name(); \
+  static testRegistration name##Registration(#name, name); \
+  static void name()
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+  do { \
+    long long expectedValue = (expected); \
+    long long actualValue = (actual); \
+    if (expectedValue != actualValue) { \
+      printf("  %s:%d: %s is %lld, expected %s (%lld)\n", __FILE__, __LINE__, \
+             #actual, actualValue, #expected, expectedValue); \
+      testFailures++; \
+    } \
+  } while (0)
+
+int main() {
+  int failedCases = 0;
+  for (int i = 0; i < testCaseCount; i++) {
+    int failuresBefore = testFailures;
+    testCases[i].function();
+    bool passed = (testFailures == failuresBefore);
+    if (!passed)
+      failedCases++;
+    printf("%s %s\n", passed ? "ok  " : "FAIL", testCases[i].name);
+  }
+  printf("%d of %d passed\n", testCaseCount - failedCases, testCaseCount);
+  return failedCases ? 1 : 0;
+}
+
+#endif
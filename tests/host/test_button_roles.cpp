@@ -0,0 +1,119 @@
+// Dispatching every button edge of a loop through buttonRoles (control_modes.h)
+
+#include <algorithm>
+
+#include "test.h"
+#include "sketch.h"
+
+#define MEDIA_MODE 1
+
+// the consumer keys held down by the last consumer report, in report order
+static std::vector<uint16_t> consumerKeysHeld() {
+  std::vector<uint16_t> keys;
+  for (auto report = simHidReports.rbegin(); report != simHidReports.rend(); ++report) {
+    if (report->id != HID_REPORTID_CONSUMERCONTROL)
+      continue;
+    for (size_t i = 0; i + 1 < report->data.size(); i += 2) {
+      uint16_t key = report->data[i] | (report->data[i + 1] << 8);
+      if (key)
+        keys.push_back(key);
+    }
+    break;
+  }
+  return keys;
+}
+
+static uint16_t ownKey(actionSlot slot) {
+  return loadAction(MEDIA_MODE, slot).keys[0].keyCode();
+}
+
+static void start() {
+  simPowerOn();
+  simRunUntil(1000000);
+  CHECK_EQUAL(MEDIA_MODE, currentModeIndex);
+  simHidReports.clear();
+}
+
+// Run loops until one sees a press; returns the buttons it saw pressed
+static uint8_t loopUntilPressed() {
+  while (true) {
+    simLoop();
+    if (buttonsPressed)
+      return buttonsPressed;
+  }
+}
+
+TEST(simultaneousPressesAreAllHandledInOneLoop) {
+  start();
+  unsigned long at = simMicros + 1000;
+  simSchedulePress(at, BUTTON_LEFT, 50000);
+  simSchedulePress(at, BUTTON_MIDDLE, 50000);
+  simSchedulePress(at, BUTTON_RIGHT, 50000);
+
+  CHECK_EQUAL(_BV(BUTTON_LEFT) | _BV(BUTTON_MIDDLE) | _BV(BUTTON_RIGHT), loopUntilPressed());
+  std::vector<uint16_t> held = consumerKeysHeld();
+  CHECK_EQUAL(3, held.size());
+  CHECK(std::count(held.begin(), held.end(), ownKey(LEFT_ACTION)) == 1);
+  CHECK(std::count(held.begin(), held.end(), ownKey(MIDDLE_ACTION)) == 1);
+  CHECK(std::count(held.begin(), held.end(), ownKey(RIGHT_ACTION)) == 1);
+
+  // and so are the releases
+  simRunUntil(at + 50000 - 1000);
+  while (!buttonsReleased) {
+    simLoop();
+  }
+  CHECK_EQUAL(_BV(BUTTON_LEFT) | _BV(BUTTON_MIDDLE) | _BV(BUTTON_RIGHT), buttonsReleased);
+  CHECK(consumerKeysHeld().empty());
+}
+
+TEST(commandAndActionInOneLoop) {
+  start();
+  unsigned long at = simMicros + 1000;
+  simSchedulePress(at, BUTTON_UP, 50000);
+  simSchedulePress(at, BUTTON_RIGHT, 50000);
+  CHECK_EQUAL(_BV(BUTTON_UP) | _BV(BUTTON_RIGHT), loopUntilPressed());
+  // edges go in BUTTON_* order, so the next mode's right action
+  CHECK_EQUAL(MEDIA_MODE + 1, currentModeIndex);
+  CHECK_EQUAL(1, simHidReports.size());
+  controlAction right = loadAction(MEDIA_MODE + 1, RIGHT_ACTION);
+  uint16_t lastKey = 0;
+  for (uint8_t i = 0; i < MAX_KEYS_PER_ACTION; i++) {
+    if (right.keys[i].packed)
+      lastKey = right.keys[i].packed;
+  }
+  const traceEvent &last = traceBuffer[(traceNext + TRACE_SIZE - 1) % TRACE_SIZE];
+  CHECK_EQUAL(TRACE_KEY_PRESS, last.type);
+  CHECK_EQUAL(lastKey, last.value);
+}
+
+TEST(eachRoleGoesToItsHandler) {
+  start();
+  for (uint8_t button = 0; button < NUMBER_OF_BUTTONS; button++) {
+    gestureEvent event = {GESTURE_TAP_DOWN, button, NULL};
+    controlAction action;
+    uint8_t command = gestureCommand(event, action);
+    CHECK_EQUAL(pgm_read_byte(&buttonRoles[button].command), command);
+    if (command == COMMAND_SEND_ACTION) {
+      actionSlot slot = (actionSlot)pgm_read_byte(&buttonRoles[button].slot);
+      CHECK_EQUAL(currentAction(slot).keys[0].packed, action.keys[0].packed);
+    }
+  }
+  CHECK_EQUAL(COMMAND_NEXT_MODE, pgm_read_byte(&buttonRoles[BUTTON_UP].command));
+  CHECK_EQUAL(COMMAND_TOGGLE_MODE, pgm_read_byte(&buttonRoles[BUTTON_DOWN].command));
+}
+
+TEST(actionRoleSendsItsSlot) {
+  start();
+  simSchedulePress(simMicros + 1000, BUTTON_LEFT, 50000);
+  loopUntilPressed();
+  CHECK(consumerKeysHeld() == std::vector<uint16_t>{ownKey(LEFT_ACTION)});
+  CHECK_EQUAL(MEDIA_MODE, currentModeIndex);
+}
+
+TEST(commandRoleRunsItsCommand) {
+  start();
+  simSchedulePress(simMicros + 1000, BUTTON_UP, 50000);
+  loopUntilPressed();
+  CHECK_EQUAL(MEDIA_MODE + 1, currentModeIndex);
+  CHECK(simHidReports.empty());
+}
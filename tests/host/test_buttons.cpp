@@ -0,0 +1,92 @@
+// Debouncing every button at once from one sample (buttons.h)
+
+#include "test.h"
+#include "sketch.h"
+
+#define MIDDLE _BV(BUTTON_MIDDLE)
+#define LEFT _BV(BUTTON_LEFT)
+
+static void resetDebouncer() {
+  buttonsDebounced = 0;
+  buttonCountLow = 0;
+  buttonCountHigh = 0;
+}
+
+TEST(edgesAreTakenAtTheFirstSample) {
+  resetDebouncer();
+  debounceButtons(MIDDLE);
+  CHECK_EQUAL(MIDDLE, buttonsPressed);
+  CHECK_EQUAL(0, buttonsReleased);
+  CHECK_EQUAL(MIDDLE, buttonsDebounced);
+}
+
+TEST(bouncesAreLockedOut) {
+  resetDebouncer();
+  debounceButtons(MIDDLE);
+  uint8_t bounces[BUTTON_DEBOUNCE_SAMPLES] = {0, MIDDLE, 0};
+  for (uint8_t sample : bounces) {
+    debounceButtons(sample);
+    CHECK_EQUAL(0, buttonsPressed | buttonsReleased);
+    CHECK_EQUAL(MIDDLE, buttonsDebounced);
+  }
+
+  // the lockout is over: the next sample that differs is a release
+  debounceButtons(MIDDLE);
+  CHECK_EQUAL(0, buttonsPressed | buttonsReleased);
+  debounceButtons(0);
+  CHECK_EQUAL(MIDDLE, buttonsReleased);
+  CHECK_EQUAL(0, buttonsDebounced);
+}
+
+TEST(lockoutLastsBUTTON_DEBOUNCE_SAMPLES) {
+  resetDebouncer();
+  debounceButtons(MIDDLE);
+  for (uint8_t i = 0; i < BUTTON_DEBOUNCE_SAMPLES; i++) {
+    debounceButtons(0);
+  }
+  CHECK_EQUAL(0, buttonsReleased);
+  debounceButtons(0);
+  CHECK_EQUAL(MIDDLE, buttonsReleased);
+}
+
+TEST(buttonsAreDebouncedApart) {
+  resetDebouncer();
+  debounceButtons(MIDDLE);
+  debounceButtons(MIDDLE | LEFT); // LEFT isn't locked out by MIDDLE
+  CHECK_EQUAL(LEFT, buttonsPressed);
+  debounceButtons(LEFT); // MIDDLE still is
+  CHECK_EQUAL(0, buttonsReleased);
+  CHECK_EQUAL(MIDDLE | LEFT, buttonsDebounced);
+}
+
+TEST(buttonsHeldAtPowerOnAreNotPressed) {
+  simReset();
+  simSetPin(simButtonPins[BUTTON_LEFT], LOW);
+  buttonsSetup();
+  CHECK_EQUAL(LEFT, buttonsDebounced);
+  simAdvance(BUTTON_SAMPLE_TIME * 1000UL);
+  readButtons();
+  CHECK_EQUAL(0, buttonsPressed);
+}
+
+TEST(bouncyPressIsOnePressSoon) {
+  simPowerOn();
+  simRunUntil(1000000);
+  unsigned long pressAt = simMicros + 1000;
+  simSchedulePress(pressAt, BUTTON_LEFT, 100000, 3);
+
+  int presses = 0, releases = 0;
+  unsigned long pressSeenAt = 0;
+  while (simMicros < pressAt + 300000) {
+    simLoop();
+    if (leftButton.wasPressed()) {
+      presses++;
+      pressSeenAt = simMicros;
+    }
+    if (leftButton.wasReleased())
+      releases++;
+  }
+  CHECK_EQUAL(1, presses);
+  CHECK_EQUAL(1, releases);
+  CHECK(pressSeenAt - pressAt <= BUTTON_SAMPLE_TIME * 1000UL + 1000);
+}
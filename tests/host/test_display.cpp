@@ -0,0 +1,67 @@
+// Drawing the display a budgeted piece at a time (display.h)
+
+#include "test.h"
+#include "sketch.h"
+
+// the longest simLoop() from now until the display has nothing left to draw
+static unsigned long longestLoopWhileDrawing() {
+  unsigned long longest = 0;
+  do {
+    unsigned long took = simLoop();
+    if (took > longest)
+      longest = took;
+  } while (displayBusy(displayFields, NUMBER_OF_FIELDS));
+  return longest;
+}
+
+static void start() {
+  simPowerOn();
+  simRunUntil(1000000);
+  CHECK(!displayBusy(displayFields, NUMBER_OF_FIELDS));
+}
+
+TEST(stepsFitTheBudget) {
+  CHECK((3 + DISPLAY_STEP_BYTES) * DISPLAY_BYTE_MICROS <= DISPLAY_TIME_BUDGET);
+}
+
+TEST(modeSwitchRedrawKeepsLoopsShort) {
+  start();
+  uint8_t modeBefore = currentModeIndex;
+  simSchedulePress(simMicros + 1000, BUTTON_UP, 50000);
+  while (currentModeIndex == modeBefore) {
+    simLoop();
+  }
+  CHECK(displayBusy(displayFields, NUMBER_OF_FIELDS));
+  unsigned long bytesBefore = simDisplayBytes;
+  unsigned long longest = longestLoopWhileDrawing();
+  printf("  mode switch: %lu display bytes, longest loop %luus\n", simDisplayBytes - bytesBefore, longest);
+  // a step may start just before the budget runs out
+  CHECK(longest <= 2 * DISPLAY_TIME_BUDGET + 500);
+}
+
+TEST(fullRedrawKeepsLoopsShort) {
+  start();
+  invalidateDisplay();
+  updateDisplay();
+  unsigned long bytesBefore = simDisplayBytes;
+  unsigned long longest = longestLoopWhileDrawing();
+  printf("  full redraw: %lu display bytes, longest loop %luus\n", simDisplayBytes - bytesBefore, longest);
+  // clearing alone is 8 rows of 128 bytes
+  CHECK(simDisplayBytes - bytesBefore >= 8 * 128);
+  CHECK(longest <= 2 * DISPLAY_TIME_BUDGET + 500);
+}
+
+TEST(piecesDrawTheSameAsAWholeRedraw) {
+  start();
+  invalidateDisplay();
+  updateDisplay();
+  unsigned long bytesBefore = simDisplayBytes;
+  drainDisplay();
+  unsigned long drained = simDisplayBytes - bytesBefore;
+
+  invalidateDisplay();
+  updateDisplay();
+  bytesBefore = simDisplayBytes;
+  longestLoopWhileDrawing();
+  CHECK_EQUAL(drained, simDisplayBytes - bytesBefore);
+}
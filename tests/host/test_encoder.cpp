@@ -0,0 +1,151 @@
+// Quadrature decoding through the transition table (encoder.h)
+
+#include "test.h"
+#include "sketch.h"
+
+static void resetEncoder() {
+  encoderState = ENCODER_REST_STATE;
+  encoderSteps = 0;
+  encoderInvalidTransitions = 0;
+  encoderBouncedTransitions = 0;
+  encoderQueueOverflows = 0;
+  encoderQueueHead = 0;
+  encoderQueueTail = 0;
+}
+
+static uint8_t queued() {
+  return encoderQueueHead - encoderQueueTail;
+}
+
+// position of a state in the CW sequence 11, 01, 00, 10
+static int sequencePosition(uint8_t state) {
+  for (int i = 0; i < 4; i++) {
+    if (simEncoderSequence[i] == state)
+      return i;
+  }
+  return -1;
+}
+
+// feed the decoder `detents` detents from where it is, negative for CCW
+static void turn(int detents) {
+  int position = sequencePosition(encoderState);
+  int direction = (detents < 0) ? -1 : 1;
+  for (int s = 0; s < abs(detents) * ENCODER_STEPS_PER_DETENT; s++) {
+    position = (position + 4 + direction) % 4;
+    decodeEncoder(simEncoderSequence[position]);
+  }
+}
+
+TEST(tableFollowsTheGrayCode) {
+  for (uint8_t from = 0; from < 4; from++) {
+    for (uint8_t to = 0; to < 4; to++) {
+      int distance = (sequencePosition(to) - sequencePosition(from) + 4) % 4;
+      int8_t expected = (distance == 0) ? 0 : (distance == 1) ? 1 : (distance == 3) ? -1 : ENCODER_INVALID;
+      CHECK_EQUAL(expected, (int8_t)pgm_read_byte(&encoderTransitions[(from << 2) | to]));
+    }
+  }
+}
+
+TEST(eachDetentIsQueuedOnce) {
+  resetEncoder();
+  turn(3);
+  CHECK_EQUAL(3, queued());
+  turn(-2);
+  CHECK_EQUAL(5, queued());
+
+  CHECK_EQUAL(3, takeEncoderDetents(0, 127));
+  CHECK_EQUAL(-2, takeEncoderDetents(0, 127));
+  CHECK_EQUAL(0, queued());
+  CHECK_EQUAL(0, encoderInvalidTransitions);
+  CHECK_EQUAL(0, encoderBouncedTransitions);
+}
+
+TEST(detentsEndAtADetentPosition) {
+  resetEncoder();
+  for (uint8_t s = 0; s < ENCODER_STEPS_PER_DETENT - 1; s++) {
+    decodeEncoder(simEncoderSequence[s + 1]);
+    CHECK_EQUAL(0, queued());
+  }
+  decodeEncoder(simEncoderSequence[ENCODER_STEPS_PER_DETENT % 4]);
+  CHECK_EQUAL(1, queued());
+}
+
+TEST(chatterIsCountedNotQueued) {
+  resetEncoder();
+  decodeEncoder(0b01); // a quarter step CW
+  decodeEncoder(0b11); // and straight back
+  CHECK_EQUAL(0, queued());
+  CHECK_EQUAL(1, encoderBouncedTransitions);
+
+  // chatter on A in the middle of a detent still ends in one detent
+  decodeEncoder(0b01);
+  decodeEncoder(0b11);
+  decodeEncoder(0b01);
+  decodeEncoder(0b00);
+  #ifndef ENCODER_HALF_STEP
+    decodeEncoder(0b10);
+    decodeEncoder(0b11);
+  #endif
+  CHECK_EQUAL(1, queued());
+  CHECK_EQUAL(1, takeEncoderDetents(0, 127));
+}
+
+TEST(missedStatesAreInvalid) {
+  resetEncoder();
+  decodeEncoder(0b00); // both pins at once
+  CHECK_EQUAL(1, encoderInvalidTransitions);
+  CHECK_EQUAL(0, queued());
+
+  decodeEncoder(0b00); // no change, e.g. another pin on the port
+  CHECK_EQUAL(1, encoderInvalidTransitions);
+}
+
+TEST(fullQueueDropsDetents) {
+  resetEncoder();
+  turn(ENCODER_QUEUE_SIZE + 3);
+  CHECK_EQUAL(ENCODER_QUEUE_SIZE, queued());
+  CHECK_EQUAL(3, encoderOverflowCount());
+}
+
+TEST(takingStopsAtAChangeOfDirection) {
+  resetEncoder();
+  turn(2);
+  turn(-1);
+  turn(1);
+  CHECK_EQUAL(2, takeEncoderDetents(0, 127));
+  CHECK_EQUAL(0, takeEncoderDetents(1, 127)); // the wrong way
+  CHECK_EQUAL(-1, takeEncoderDetents(-1, 127));
+  CHECK_EQUAL(1, takeEncoderDetents(0, 1));
+}
+
+/* Every detent reaches the host at any speed a hand turns the wheel. Past
+   about 500 detents/s the presses and releases of an action that can't be
+   batched need more USB frames than there are. */
+TEST(rateSweep) {
+  const unsigned int rates[] = {5, 20, 50, 100, 200, 400};
+  for (unsigned int rate : rates) {
+    simPowerOn();
+    simEncoderState = ENCODER_REST_STATE;
+    selectMode(0); // Volume: one consumer press per detent
+    simRunUntil(1000000);
+    resetEncoder();
+    simHidReports.clear();
+
+    int detents = rate / 5 + 10;
+    simScheduleDetents(simMicros + 1000, -detents, 1000000 / rate);
+    simRunUntil(simMicros + detents * (1000000 / rate) + 1000000);
+
+    int presses = 0;
+    for (const simHidReport &report : simHidReports) {
+      if ((report.id == HID_REPORTID_CONSUMERCONTROL) && (report.data[0] | (report.data[1] << 8)))
+        presses++;
+    }
+    if (presses != detents)
+      printf("  %u detents/s\n", rate);
+    // accelerated detents can be repeated, never dropped
+    CHECK(presses >= detents);
+    CHECK_EQUAL(0, encoderInvalidTransitions);
+    CHECK_EQUAL(0, encoderBouncedTransitions);
+    CHECK_EQUAL(0, encoderQueueOverflows);
+  }
+}
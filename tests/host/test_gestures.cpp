@@ -0,0 +1,117 @@
+// Taps, double taps, holds and chords from the button edges (gestures.h)
+
+#define MEDIA_MODE 1
+
+// a double tap of left and a hold of right, in the Media mode only; labels
+// have to be ones of mode_labels.h
+#define EXTRA_GESTURE_BINDINGS \
+  {MEDIA_MODE, GESTURE_DOUBLE_TAP, BUTTON_LEFT, 0, COMMAND_SEND_ACTION, {"Mute", CONSUMER_KEY(MEDIA_VOLUME_MUTE)}}, \
+  {MEDIA_MODE, GESTURE_HOLD, BUTTON_RIGHT, 0, COMMAND_SEND_ACTION, {"Mute", CONSUMER_KEY(MEDIA_STOP)}},
+
+#include "test.h"
+#include "sketch.h"
+
+// the consumer keys pressed by the reports since `from`, in order
+static std::vector<uint16_t> consumerPresses(size_t from = 0) {
+  std::vector<uint16_t> keys;
+  for (size_t i = from; i < simHidReports.size(); i++) {
+    const simHidReport &report = simHidReports[i];
+    uint16_t key = report.data[0] | (report.data[1] << 8);
+    if ((report.id == HID_REPORTID_CONSUMERCONTROL) && key)
+      keys.push_back(key);
+  }
+  return keys;
+}
+
+static uint16_t ownKey(uint8_t mode, actionSlot slot) {
+  return loadAction(mode, slot).keys[0].keyCode();
+}
+
+static void start(uint8_t mode) {
+  simPowerOn();
+  selectMode(mode);
+  simRunUntil(1000000);
+  simHidReports.clear();
+}
+
+// Run loops until a button edge is seen; returns the HID reports sent by that loop
+static size_t loopUntilEdge(uint8_t button) {
+  while (true) {
+    size_t before = simHidReports.size();
+    simLoop();
+    if (bitRead(buttonsPressed | buttonsReleased, button))
+      return simHidReports.size() - before;
+  }
+}
+
+TEST(unboundTapIsSentInTheLoopOfItsEdge) {
+  start(MEDIA_MODE);
+  simSchedulePress(simMicros + 1000, BUTTON_MIDDLE, 50000);
+  CHECK_EQUAL(1, loopUntilEdge(BUTTON_MIDDLE));
+  CHECK(consumerPresses() == std::vector<uint16_t>{ownKey(MEDIA_MODE, MIDDLE_ACTION)});
+  CHECK_EQUAL(1, loopUntilEdge(BUTTON_MIDDLE)); // the release
+}
+
+TEST(bindingsOnlyHoldBackTheirMode) {
+  start(3); // YouTube
+  simSchedulePress(simMicros + 1000, BUTTON_LEFT, 50000);
+  CHECK_EQUAL(1, loopUntilEdge(BUTTON_LEFT));
+}
+
+TEST(tapWithADoubleTapBoundWaitsForItsWindow) {
+  start(MEDIA_MODE);
+  simSchedulePress(simMicros + 1000, BUTTON_LEFT, 50000);
+  CHECK_EQUAL(0, loopUntilEdge(BUTTON_LEFT));
+  CHECK_EQUAL(0, loopUntilEdge(BUTTON_LEFT));
+  unsigned long releasedAt = simMicros;
+
+  simRunUntil(releasedAt + GESTURE_DOUBLE_TAP_TIME * 1000UL - 5000);
+  CHECK(consumerPresses().empty());
+  simRunUntil(releasedAt + GESTURE_DOUBLE_TAP_TIME * 1000UL + 10000);
+  CHECK(consumerPresses() == std::vector<uint16_t>{ownKey(MEDIA_MODE, LEFT_ACTION)});
+}
+
+TEST(doubleTapSendsOnlyItsBinding) {
+  start(MEDIA_MODE);
+  simSchedulePress(simMicros + 1000, BUTTON_LEFT, 50000);
+  simSchedulePress(simMicros + 120000, BUTTON_LEFT, 50000);
+  loopUntilEdge(BUTTON_LEFT);
+  loopUntilEdge(BUTTON_LEFT);
+  CHECK(consumerPresses().empty());
+  CHECK_EQUAL(1, loopUntilEdge(BUTTON_LEFT)); // the second press
+  simRunUntil(simMicros + 1000000);
+  CHECK(consumerPresses() == std::vector<uint16_t>{MEDIA_VOLUME_MUTE});
+}
+
+TEST(holdFiresOnlyAfterItsWindow) {
+  start(MEDIA_MODE);
+  simSchedulePress(simMicros + 1000, BUTTON_RIGHT, 800000);
+  CHECK_EQUAL(0, loopUntilEdge(BUTTON_RIGHT));
+  unsigned long pressedAt = simMicros;
+
+  simRunUntil(pressedAt + GESTURE_HOLD_TIME * 1000UL - 5000);
+  CHECK(consumerPresses().empty());
+  simRunUntil(pressedAt + GESTURE_HOLD_TIME * 1000UL + 10000);
+  CHECK(consumerPresses() == std::vector<uint16_t>{MEDIA_STOP});
+  simRunUntil(simMicros + 1000000);
+  CHECK(consumerPresses() == std::vector<uint16_t>{MEDIA_STOP});
+}
+
+TEST(shortPressWithAHoldBoundIsATapOnRelease) {
+  start(MEDIA_MODE);
+  simSchedulePress(simMicros + 1000, BUTTON_RIGHT, 100000);
+  CHECK_EQUAL(0, loopUntilEdge(BUTTON_RIGHT));
+  loopUntilEdge(BUTTON_RIGHT);
+  CHECK(consumerPresses() == std::vector<uint16_t>{ownKey(MEDIA_MODE, RIGHT_ACTION)});
+}
+
+TEST(upAndMiddleSwitchLayoutWithoutSendingAnAction) {
+  start(MEDIA_MODE);
+  uint8_t layoutBefore = currentLayoutIndex;
+  simSchedulePress(simMicros + 1000, BUTTON_UP, 300000);
+  simSchedulePress(simMicros + 100000, BUTTON_MIDDLE, 50000);
+  simRunUntil(simMicros + 1000000);
+  CHECK_EQUAL((layoutBefore + 1) % numberOfLayouts, currentLayoutIndex);
+  CHECK(consumerPresses().empty());
+  CHECK(simHidReports.empty());
+}
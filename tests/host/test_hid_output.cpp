@@ -0,0 +1,116 @@
+// Staged keys going out as one report per device (hid_output.h)
+
+#include "test.h"
+#include "sketch.h"
+
+#define VLC_MODE 2
+
+static int reportsWithId(uint8_t id) {
+  int count = 0;
+  for (const simHidReport &report : simHidReports) {
+    if (report.id == id)
+      count++;
+  }
+  return count;
+}
+
+static controlAction actionOf(actionKeypress a, actionKeypress b = actionKeypress(), actionKeypress c = actionKeypress()) {
+  controlAction action;
+  action.keys[0] = a;
+  action.keys[1] = b;
+  action.keys[2] = c;
+  return action;
+}
+
+static void start() {
+  simPowerOn();
+  simRunUntil(1000000);
+  simHidReports.clear();
+  hidReportCount = 0;
+}
+
+TEST(chordGoesOutInOneReport) {
+  start();
+  controlAction action = loadAction(VLC_MODE, WHEEL_CW_ACTION); // Ctrl+GUI+Left
+  sendAction(action);
+  CHECK_EQUAL(1, simHidReports.size());
+  if (simHidReports.size() == 1) {
+    const simHidReport &report = simHidReports[0];
+    CHECK_EQUAL(HID_REPORTID_KEYBOARD, report.id);
+    CHECK_EQUAL((1 << (KEY_LEFT_CTRL - KEY_LEFT_CTRL)) | (1 << (KEY_LEFT_GUI - KEY_LEFT_CTRL)), report.data[0]);
+    CHECK_EQUAL(KEY_LEFT_ARROW, report.data[2]);
+    CHECK_EQUAL(0, report.data[3]);
+  }
+
+  releaseAction(action);
+  CHECK_EQUAL(2, simHidReports.size());
+  if (simHidReports.size() == 2) {
+    const std::vector<uint8_t> &released = simHidReports[1].data;
+    CHECK(std::vector<uint8_t>(released.size(), 0) == released);
+  }
+  CHECK_EQUAL(simHidReports.size(), hidReportCount);
+}
+
+TEST(consumerKeysShareAReport) {
+  start();
+  controlAction action = actionOf(CONSUMER_KEY(MEDIA_VOLUME_UP), CONSUMER_KEY(MEDIA_PLAY_PAUSE));
+  sendAction(action);
+  CHECK_EQUAL(1, simHidReports.size());
+  CHECK_EQUAL(1, reportsWithId(HID_REPORTID_CONSUMERCONTROL));
+  if (simHidReports.size() == 1) {
+    const std::vector<uint8_t> &data = simHidReports[0].data;
+    CHECK_EQUAL(MEDIA_VOLUME_UP, data[0] | (data[1] << 8));
+    CHECK_EQUAL(MEDIA_PLAY_PAUSE, data[2] | (data[3] << 8));
+  }
+  releaseAction(action);
+  CHECK_EQUAL(2, reportsWithId(HID_REPORTID_CONSUMERCONTROL));
+}
+
+TEST(oneReportPerDevice) {
+  start();
+  controlAction action = actionOf(KEYBOARD_KEY(KEY_LEFT_SHIFT), CONSUMER_KEY(MEDIA_VOLUME_MUTE), KEYBOARD_KEY(KEY_A));
+  sendAction(action);
+  CHECK_EQUAL(1, reportsWithId(HID_REPORTID_KEYBOARD));
+  CHECK_EQUAL(1, reportsWithId(HID_REPORTID_CONSUMERCONTROL));
+  CHECK_EQUAL(2, simHidReports.size());
+
+  releaseAction(action);
+  CHECK_EQUAL(2, reportsWithId(HID_REPORTID_KEYBOARD));
+  CHECK_EQUAL(2, reportsWithId(HID_REPORTID_CONSUMERCONTROL));
+  CHECK_EQUAL(simHidReports.size(), hidReportCount);
+}
+
+TEST(modifiersGoDownBeforeAClick) {
+  start();
+  controlAction action = actionOf(KEYBOARD_KEY(KEY_LEFT_SHIFT), MOUSE_ACTION(MOUSE_LEFT_CLICK));
+  sendAction(action);
+  CHECK_EQUAL(3, simHidReports.size()); // shift, then the click pressed and released
+  if (simHidReports.size() == 3) {
+    CHECK_EQUAL(HID_REPORTID_KEYBOARD, simHidReports[0].id);
+    CHECK_EQUAL(HID_REPORTID_MOUSE, simHidReports[1].id);
+    CHECK_EQUAL(MOUSE_LEFT, simHidReports[1].data[0]);
+    CHECK_EQUAL(0, simHidReports[2].data[0]);
+  }
+  CHECK_EQUAL(simHidReports.size(), hidReportCount);
+}
+
+TEST(hostNeverSeesPartOfAChord) {
+  start();
+  selectMode(VLC_MODE);
+  simRunUntil(simMicros + 500000);
+  simHidReports.clear();
+  // slower than WHEEL_ACCEL_VELOCITY, so each detent is the Ctrl+GUI+Left of "<"
+  simScheduleDetents(simMicros + 1000, 5, 100000);
+  simRunUntil(simMicros + 600000);
+
+  int presses = 0;
+  for (const simHidReport &report : simHidReports) {
+    CHECK_EQUAL(HID_REPORTID_KEYBOARD, report.id);
+    bool released = (report.data[0] == 0) && (report.data[2] == 0);
+    bool chord = (report.data[0] == 0x09) && (report.data[2] == KEY_LEFT_ARROW) && (report.data[3] == 0);
+    CHECK(released || chord);
+    if (chord)
+      presses++;
+  }
+  CHECK_EQUAL(5, presses);
+}
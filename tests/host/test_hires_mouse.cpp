@@ -0,0 +1,134 @@
+// The high-resolution mouse's USB interface and reports (hires_mouse.h)
+
+#include "test.h"
+#include "sketch.h"
+
+// Total bits of the input and feature items of a report descriptor
+struct reportSizes {
+  int input = 0;
+  int feature = 0;
+  bool reportId = false;
+};
+
+static reportSizes parseDescriptor(const uint8_t *descriptor, size_t length) {
+  reportSizes sizes;
+  int reportSize = 0, reportCount = 0;
+  for (size_t i = 0; i < length;) {
+    uint8_t prefix = descriptor[i];
+    uint8_t dataLength = (prefix & 0x03) == 3 ? 4 : (prefix & 0x03);
+    uint32_t value = 0;
+    for (uint8_t b = 0; b < dataLength; b++) {
+      value |= (uint32_t)descriptor[i + 1 + b] << (8 * b);
+    }
+    switch (prefix & 0xFC) {
+    case 0x74: reportSize = value; break;
+    case 0x94: reportCount = value; break;
+    case 0x84: sizes.reportId = true; break;
+    case 0x80: sizes.input += reportSize * reportCount; break;
+    case 0xB0: sizes.feature += reportSize * reportCount; break;
+    }
+    i += 1 + dataLength;
+  }
+  return sizes;
+}
+
+static uint8_t hiResInterface() {
+  uint8_t count = 0;
+  simControlReply.clear();
+  PluggableUSB().getInterface(&count);
+  return simControlReply.size() >= 3 ? simControlReply[2] : 0xFF;
+}
+
+static bool setMultiplier(uint8_t value) {
+  return simControlRequest(REQUEST_HOSTTODEVICE_CLASS_INTERFACE, HID_SET_REPORT,
+                           HID_REPORT_TYPE_FEATURE << 8, hiResInterface(), &value, 1);
+}
+
+TEST(descriptorMatchesTheReports) {
+  reportSizes sizes = parseDescriptor(hiResMouseDescriptor, sizeof(hiResMouseDescriptor));
+  CHECK(!sizes.reportId);
+  CHECK_EQUAL(8 * sizeof(hiResMouseReport), sizes.input);
+  CHECK_EQUAL(8, sizes.feature);
+}
+
+TEST(interfaceDescribesTheMouse) {
+  uint8_t count = 0;
+  simControlReply.clear();
+  CHECK_EQUAL(sizeof(HIDDescriptor), PluggableUSB().getInterface(&count));
+  CHECK_EQUAL(1, count);
+  CHECK_EQUAL(sizeof(HIDDescriptor), simControlReply.size());
+
+  HIDDescriptor descriptor;
+  memcpy(&descriptor, simControlReply.data(), sizeof(descriptor));
+  CHECK_EQUAL(USB_DEVICE_CLASS_HUMAN_INTERFACE, descriptor.hid.interfaceClass);
+  CHECK_EQUAL(sizeof(hiResMouseDescriptor), descriptor.desc.descLenL | (descriptor.desc.descLenH << 8));
+  CHECK_EQUAL(USB_ENDPOINT_TYPE_INTERRUPT, descriptor.in.attr);
+  CHECK(descriptor.in.addr & 0x80);
+
+  CHECK(simControlRequest(REQUEST_DEVICETOHOST_STANDARD_INTERFACE, 6, HID_REPORT_DESCRIPTOR_TYPE << 8,
+                          descriptor.hid.number));
+  CHECK_EQUAL(sizeof(hiResMouseDescriptor), simControlReply.size());
+  CHECK(memcmp(simControlReply.data(), hiResMouseDescriptor, sizeof(hiResMouseDescriptor)) == 0);
+}
+
+TEST(hostSetsTheMultiplier) {
+  simPowerOn();
+  CHECK(setMultiplier(0));
+  CHECK(!HiResMouse.highResolution());
+  CHECK(setMultiplier(1));
+  CHECK(HiResMouse.highResolution());
+
+  CHECK(simControlRequest(REQUEST_DEVICETOHOST_CLASS_INTERFACE, HID_GET_REPORT,
+                          HID_REPORT_TYPE_FEATURE << 8, hiResInterface()));
+  CHECK_EQUAL(1, simControlReply.size());
+  CHECK_EQUAL(1, simControlReply[0]);
+
+  // enumerated again: back to whole lines until the host says otherwise
+  simControlRequest(REQUEST_DEVICETOHOST_STANDARD_INTERFACE, 6, HID_REPORT_DESCRIPTOR_TYPE << 8, hiResInterface());
+  CHECK(!HiResMouse.highResolution());
+}
+
+TEST(otherInterfacesAreLeftAlone) {
+  uint8_t value = 1;
+  CHECK(!simControlRequest(REQUEST_HOSTTODEVICE_CLASS_INTERFACE, HID_SET_REPORT,
+                           HID_REPORT_TYPE_FEATURE << 8, hiResInterface() + 1, &value, 1));
+  CHECK(!simControlRequest(REQUEST_HOSTTODEVICE_CLASS_INTERFACE, HID_SET_REPORT,
+                           HID_REPORT_TYPE_OUTPUT << 8, hiResInterface(), &value, 1));
+}
+
+TEST(highResolutionScrollsInUnits) {
+  simPowerOn();
+  setMultiplier(1);
+  simHidReports.clear();
+  scrollMouseHiRes(-3);
+  scrollMouseHiRes(200);
+  CHECK_EQUAL(3, simHidReports.size());
+  for (const simHidReport &report : simHidReports) {
+    CHECK(report.endpoint != SIM_HID_ENDPOINT);
+    CHECK_EQUAL(3, report.data.size());
+    CHECK_EQUAL(0, report.data[0]);
+    CHECK_EQUAL(0, report.data[1]);
+  }
+  if (simHidReports.size() == 3) {
+    CHECK_EQUAL(-3, (int8_t)simHidReports[0].data[2]);
+    CHECK_EQUAL(127, (int8_t)simHidReports[1].data[2]);
+    CHECK_EQUAL(73, (int8_t)simHidReports[2].data[2]);
+  }
+}
+
+TEST(withoutTheMultiplierWholeLinesAreScrolled) {
+  simPowerOn();
+  setMultiplier(0);
+  hiResScrollRemainder = 0;
+  simHidReports.clear();
+  scrollMouseHiRes(HIRES_SCROLL_MULTIPLIER - 1);
+  CHECK_EQUAL(0, simHidReports.size());
+  scrollMouseHiRes(HIRES_SCROLL_MULTIPLIER + 2);
+  CHECK_EQUAL(1, simHidReports.size());
+  if (simHidReports.size() == 1) {
+    CHECK_EQUAL(SIM_HID_ENDPOINT, simHidReports[0].endpoint);
+    CHECK_EQUAL(HID_REPORTID_MOUSE, simHidReports[0].id);
+    CHECK_EQUAL(2, (int8_t)simHidReports[0].data[3]); // wheel
+  }
+  CHECK_EQUAL(1, hiResScrollRemainder);
+}
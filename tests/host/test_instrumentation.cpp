@@ -0,0 +1,88 @@
+// The timing statistics of ENABLE_INSTRUMENTATION (instrumentation.h)
+
+#include "test.h"
+#include "sketch.h"
+
+static uint16_t bucketOf(uint32_t value) {
+  resetTimingStats();
+  recordTiming(LOOP_PERIOD_STAT, value);
+  for (uint8_t b = 0; b < INSTRUMENTATION_BUCKETS; b++) {
+    if (timingStats[LOOP_PERIOD_STAT].buckets[b])
+      return b;
+  }
+  return 0xFFFF;
+}
+
+TEST(bucketsArePowersOfTwo) {
+  CHECK_EQUAL(0, bucketOf(0));
+  CHECK_EQUAL(1, bucketOf(1));
+  CHECK_EQUAL(2, bucketOf(2));
+  CHECK_EQUAL(2, bucketOf(3));
+  CHECK_EQUAL(3, bucketOf(4));
+  CHECK_EQUAL(10, bucketOf(1023));
+  CHECK_EQUAL(11, bucketOf(1024));
+  CHECK_EQUAL(INSTRUMENTATION_BUCKETS - 1, bucketOf(1UL << (INSTRUMENTATION_BUCKETS - 2)));
+  CHECK_EQUAL(INSTRUMENTATION_BUCKETS - 1, bucketOf(0xFFFFFFFF));
+}
+
+TEST(countMinAndMax) {
+  resetTimingStats();
+  recordTiming(DETENT_LATENCY_STAT, 700);
+  recordTiming(DETENT_LATENCY_STAT, 50);
+  recordTiming(DETENT_LATENCY_STAT, 3000);
+  CHECK_EQUAL(3, timingStats[DETENT_LATENCY_STAT].count);
+  CHECK_EQUAL(50, timingStats[DETENT_LATENCY_STAT].min);
+  CHECK_EQUAL(3000, timingStats[DETENT_LATENCY_STAT].max);
+  CHECK_EQUAL(0, timingStats[LOOP_PERIOD_STAT].count);
+
+  resetTimingStats();
+  CHECK_EQUAL(0, timingStats[DETENT_LATENCY_STAT].count);
+  CHECK_EQUAL(0xFFFFFFFF, timingStats[DETENT_LATENCY_STAT].min);
+  CHECK_EQUAL(0, timingStats[DETENT_LATENCY_STAT].max);
+  CHECK_EQUAL(0, timingStats[DETENT_LATENCY_STAT].buckets[10]);
+}
+
+TEST(bucketsSaturate) {
+  resetTimingStats();
+  for (uint32_t i = 0; i < 0x10005; i++) {
+    recordTiming(ENCODER_ISR_STAT, 5);
+  }
+  CHECK_EQUAL(0x10005, timingStats[ENCODER_ISR_STAT].count);
+  CHECK_EQUAL(0xFFFF, timingStats[ENCODER_ISR_STAT].buckets[3]);
+}
+
+TEST(statsArePrinted) {
+  resetTimingStats();
+  recordTiming(DISPLAY_UPDATE_STAT, 6);
+  recordTiming(DISPLAY_UPDATE_STAT, 100000);
+  simSerialOutput.clear();
+  printTimingStats();
+  CHECK(simSerialOutput.find("display update (us): n=2 min=6 max=100000\r\n  <8: 1\r\n  <inf: 1\r\n")
+        != std::string::npos);
+  CHECK(simSerialOutput.find("loop period (us): n=0\r\n") != std::string::npos);
+}
+
+TEST(theLoopIsMeasured) {
+  simPowerOn();
+  simRunUntil(1000000);
+  resetTimingStats();
+  simScheduleDetents(simMicros + 1000, 10, 20000);
+  simRunUntil(simMicros + 300000);
+
+  CHECK(timingStats[LOOP_PERIOD_STAT].count > 1000);
+  CHECK(timingStats[LOOP_PERIOD_STAT].min >= SIM_LOOP_MICROS);
+  CHECK_EQUAL(10, timingStats[DETENT_LATENCY_STAT].count);
+  CHECK(timingStats[DETENT_LATENCY_STAT].max < 2 * SIM_USB_FRAME_MICROS);
+}
+
+TEST(statsCommand) {
+  simPowerOn();
+  simRunUntil(1000000);
+  simSerialSend("r");
+  simRunUntil(simMicros + 10000);
+  simSerialOutput.clear();
+  simSerialSend("s");
+  simRunUntil(simMicros + 10000);
+  CHECK(simSerialOutput.find("loop period (us): n=") != std::string::npos);
+  CHECK(simSerialOutput.find("wake to report (us): n=") != std::string::npos);
+}
@@ -0,0 +1,40 @@
+// The built-in modes' labels, kept once each in modeLabels (control_mode_structs.h)
+
+#include "test.h"
+#include "sketch.h"
+
+static bool labelIs(const char *label, const char *expected) {
+  return strcmp(label, expected) == 0;
+}
+
+TEST(modeNamesLoadFromTheTable) {
+  char label[MAX_LABEL_LENGTH];
+  CHECK(labelIs(loadModeName(label, 0), "Volume"));
+  CHECK(labelIs(loadModeName(label, 1), "Media"));
+  CHECK(labelIs(loadWheelName(label, 1), "Volume"));
+  CHECK(labelIs(loadModeName(label, numberOfModes - 1), "System"));
+}
+
+TEST(actionNamesLoadFromTheTable) {
+  char label[MAX_LABEL_LENGTH];
+  CHECK(labelIs(loadActionName(label, 1, LEFT_ACTION), "Prev\n<<"));
+  CHECK(labelIs(loadActionName(label, 1, WHEEL_CW_ACTION), "-"));
+  CHECK(labelIs(loadActionName(label, 0, LEFT_ACTION), ""));
+}
+
+TEST(sharedLabelsAreStoredOnce) {
+  CHECK_EQUAL(controlModeList[0].name.offset, controlModeList[0].wheelName.offset);
+  CHECK_EQUAL(controlModeList[0].name.offset, controlModeList[1].wheelName.offset);
+  CHECK_EQUAL(0, controlModeList[0].left.name.offset);
+}
+
+TEST(actionsKeepTheirKeys) {
+  controlAction action = loadAction(2, WHEEL_CW_ACTION); // VLC "<"
+  CHECK_EQUAL(KEYBOARD_KEY(KEY_LEFT_CTRL).packed, action.keys[0].packed);
+  CHECK_EQUAL(KEYBOARD_KEY(KEY_LEFT_GUI).packed, action.keys[1].packed);
+  CHECK_EQUAL(KEYBOARD_KEY(KEY_LEFT_ARROW).packed, action.keys[2].packed);
+
+  action = loadAction(2, WHEEL_CW_ACCEL_ACTION); // VLC "<<", one key in braces
+  CHECK_EQUAL(KEYBOARD_KEY(KEY_LEFT_ARROW).packed, action.keys[0].packed);
+  CHECK_EQUAL(0, action.keys[1].packed);
+}
@@ -0,0 +1,184 @@
+// Mode images uploaded over the serial port (mode_storage.h, serial_commands.h)
+
+#include "test.h"
+#include "sketch.h"
+
+// An image of one mode with nothing bound, as tools/encode_modes.py makes it
+static std::vector<uint8_t> modeImage(const char *name) {
+  std::vector<uint8_t> record;
+  record.push_back(strlen(name));
+  record.insert(record.end(), name, name + strlen(name));
+  record.push_back(0); // wheelName
+  for (uint8_t slot = 0; slot < NUMBER_OF_ACTION_SLOTS; slot++) {
+    record.insert(record.end(), {0, 0, 0}); // name, modeMask, keys
+  }
+  record.push_back(0); // curve points
+
+  std::vector<uint8_t> body = {MODE_IMAGE_HEADER_SIZE + 2, 0}; // offset table
+  body.insert(body.end(), record.begin(), record.end());
+
+  uint16_t length = MODE_IMAGE_HEADER_SIZE + body.size();
+  uint16_t crc = 0xFFFF;
+  for (uint8_t value : body) {
+    crc = _crc16_update(crc, value);
+  }
+  std::vector<uint8_t> image = {'S', 'W', MODE_IMAGE_VERSION, 1,
+                                (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)crc, (uint8_t)(crc >> 8)};
+  image.insert(image.end(), body.begin(), body.end());
+  return image;
+}
+
+static uint16_t imageCrc(const std::vector<uint8_t> &image) {
+  uint16_t crc = 0xFFFF;
+  for (uint8_t value : image) {
+    crc = _crc16_update(crc, value);
+  }
+  return crc;
+}
+
+// send the upload command; `sent` bytes of the image follow it
+static void sendUpload(const std::vector<uint8_t> &image, uint16_t crc, size_t sent) {
+  uint8_t frame[] = {'u', 'S', 'W', (uint8_t)image.size(), (uint8_t)(image.size() >> 8), (uint8_t)crc, (uint8_t)(crc >> 8)};
+  simSerialSend(frame, sizeof frame);
+  simSerialSend(image.data(), sent);
+}
+
+static void runFor(unsigned long micros) {
+  simSerialOutput.clear();
+  simRunUntil(simMicros + micros);
+}
+
+static bool answered(const char *line) {
+  return simSerialOutput.find(line) != std::string::npos;
+}
+
+static bool modeNameIs(const char *expected) {
+  char name[MAX_LABEL_LENGTH];
+  return strcmp(loadModeName(name, 0), expected) == 0;
+}
+
+static void upload(const char *name) {
+  std::vector<uint8_t> image = modeImage(name);
+  sendUpload(image, imageCrc(image), image.size());
+  runFor(2000000);
+}
+
+TEST(uploadReplacesTheModes) {
+  simPowerOn();
+  CHECK_EQUAL(FLASH_MODE_COUNT, numberOfModes);
+  upload("First");
+  CHECK(answered("OK 1"));
+  CHECK_EQUAL(1, numberOfModes);
+  CHECK(modeNameIs("First"));
+}
+
+TEST(uploadsAlternateSlots) {
+  simPowerOn();
+  upload("First");
+  uint8_t firstSlot = modeImageSlot;
+  upload("Second");
+  CHECK(answered("OK 1"));
+  CHECK(modeImageSlot != firstSlot);
+  CHECK(modeNameIs("Second"));
+}
+
+TEST(badCrcKeepsTheOldImage) {
+  simPowerOn();
+  upload("First");
+  std::vector<uint8_t> image = modeImage("Second");
+  sendUpload(image, imageCrc(image) ^ 1, image.size());
+  runFor(2000000);
+  CHECK(answered("ERR CRC"));
+  CHECK(modeNameIs("First"));
+}
+
+TEST(interruptedUploadKeepsTheOldImage) {
+  simPowerOn();
+  upload("First");
+  std::vector<uint8_t> image = modeImage("Second");
+  sendUpload(image, imageCrc(image), image.size() / 2);
+  runFor(100000);
+  CHECK(modeNameIs("First")); // still in use while the upload runs
+
+  // power lost part way through
+  loadModeImage();
+  CHECK_EQUAL(1, numberOfModes);
+  CHECK(modeNameIs("First"));
+
+  runFor(2000000);
+  CHECK(answered("ERR timeout"));
+  CHECK(modeNameIs("First"));
+}
+
+TEST(unframedCommandsAreIgnored) {
+  simPowerOn();
+  upload("First");
+  simSerialSend("xyz");
+  runFor(2000000);
+  CHECK(answered("ERR frame"));
+  CHECK(modeNameIs("First"));
+
+  uint8_t unframed[] = {'u', 10, 0, 0, 0, 0, 0};
+  simSerialSend(unframed, sizeof unframed);
+  runFor(2000000);
+  CHECK(answered("ERR frame"));
+  CHECK(modeNameIs("First"));
+}
+
+TEST(eraseGoesBackToTheBuiltInModes) {
+  simPowerOn();
+  upload("First");
+  simSerialSend("xSW");
+  runFor(100000);
+  CHECK(answered("OK 0"));
+  CHECK_EQUAL(FLASH_MODE_COUNT, numberOfModes);
+  CHECK(modeNameIs("Volume"));
+}
+
+// What one mode does, read through the accessors, to compare built-in and stored modes
+static std::string describeMode(uint8_t modeIndex) {
+  char text[MAX_LABEL_LENGTH];
+  std::string description = loadModeName(text, modeIndex);
+  description += "|";
+  description += loadWheelName(text, modeIndex);
+  for (uint8_t slot = 0; slot < NUMBER_OF_ACTION_SLOTS; slot++) {
+    controlAction action = loadAction(modeIndex, (actionSlot)slot);
+    description += "|";
+    description += loadActionName(text, modeIndex, (actionSlot)slot);
+    for (uint8_t i = 0; i < MAX_KEYS_PER_ACTION; i++) {
+      description += " " + std::to_string(action.keys[i].packed);
+    }
+    description += " " + std::to_string(action.modeMask);
+  }
+  for (uint16_t velocity : {0, 10, 20, 30, 50, 100}) {
+    description += " " + std::to_string(accelPercent(modeIndex, velocity));
+  }
+  return description;
+}
+
+// tools/modes.example.json, encoded by the Makefile
+TEST(exampleModesMatchTheBuiltInOnes) {
+  simPowerOn();
+  std::vector<std::string> builtIn;
+  for (uint8_t i = 0; i < numberOfModes; i++) {
+    builtIn.push_back(describeMode(i));
+  }
+
+  FILE *file = fopen("build/modes.example.bin", "rb");
+  CHECK(file != NULL);
+  if (!file)
+    return;
+  size_t length = fread(simEeprom + modeImageSlotAddress(0), 1, MODE_IMAGE_CAPACITY, file);
+  fclose(file);
+  CHECK(length > MODE_IMAGE_HEADER_SIZE);
+  simEeprom[MODE_IMAGE_ADDRESS] = 0;
+
+  CHECK(loadModeImage());
+  CHECK_EQUAL(builtIn.size(), numberOfModes);
+  for (uint8_t i = 0; i < numberOfModes && i < builtIn.size(); i++) {
+    std::string stored = describeMode(i);
+    if (stored != builtIn[i])
+      printf("  mode %d: built in %s\n          example %s\n", i, builtIn[i].c_str(), stored.c_str());
+    CHECK(stored == builtIn[i]);
+  }
+}
@@ -0,0 +1,80 @@
+// Commands from the host over the serial port (serial_commands.h)
+
+#include "test.h"
+#include "sketch.h"
+
+// power on and let the first display draw finish
+static void start() {
+  simPowerOn();
+  simRunUntil(1000000);
+  simSerialOutput.clear();
+}
+
+// the longest any of `loops` runs of loop() takes
+static unsigned long longestLoop(int loops) {
+  unsigned long longest = 0;
+  for (int i = 0; i < loops; i++) {
+    longest = std::max(longest, simLoop());
+  }
+  return longest;
+}
+
+TEST(modeCommandSelectsAMode) {
+  start();
+  simSerialSend("mYouTube\n");
+  simRunUntil(simMicros + 100000);
+  CHECK(simSerialOutput.find("OK 3") != std::string::npos);
+  CHECK_EQUAL(3, currentModeIndex);
+}
+
+TEST(partialCommandsDontBlockTheLoop) {
+  start();
+  simSerialSend("m");
+  CHECK(longestLoop(100) < 1000);
+  CHECK(simSerialOutput.empty());
+
+  simSerialSend("Mou");
+  CHECK(longestLoop(100) < 1000);
+  simSerialSend("se\n");
+  simRunUntil(simMicros + 100000);
+  CHECK(simSerialOutput.find("OK 4") != std::string::npos);
+  CHECK_EQUAL(4, currentModeIndex);
+}
+
+TEST(unfinishedCommandsTimeOut) {
+  start();
+  uint8_t mode = currentModeIndex;
+  simSerialSend("mVLC");
+  simRunUntil(simMicros + (SERIAL_COMMAND_TIMEOUT + 100) * 1000UL);
+  CHECK(simSerialOutput.find("ERR timeout") != std::string::npos);
+  CHECK_EQUAL(mode, currentModeIndex);
+
+  // and the next command is read as one
+  simSerialOutput.clear();
+  simSerialSend("m0\n");
+  simRunUntil(simMicros + 100000);
+  CHECK(simSerialOutput.find("OK 0") != std::string::npos);
+  CHECK_EQUAL(0, currentModeIndex);
+}
+
+TEST(longLabelsAreCut) {
+  start();
+  simSerialSend("lA label far too long\r\n");
+  simRunUntil(simMicros + 100000);
+  CHECK(simSerialOutput.find("OK") != std::string::npos);
+  CHECK_EQUAL(MAX_LABEL_LENGTH - 1, strlen(transientLabel));
+  CHECK(strncmp(transientLabel, "A label far", MAX_LABEL_LENGTH - 1) == 0);
+}
+
+TEST(outOfRangeModesAreRefused) {
+  start();
+  uint8_t mode = currentModeIndex;
+  const char *requests[] = {"m4294967294\n", "m65534\n", "m255\n", "m6\n", "m0006\n", "mNoSuchMode\n"};
+  for (const char *request : requests) {
+    simSerialOutput.clear();
+    simSerialSend(request);
+    simRunUntil(simMicros + 100000);
+    CHECK(simSerialOutput.find("ERR unknown mode") != std::string::npos);
+    CHECK_EQUAL(mode, currentModeIndex);
+  }
+}
@@ -0,0 +1,129 @@
+// The event trace of ENABLE_TRACE and its dump format (trace.h)
+
+#include <algorithm>
+
+#include "test.h"
+#include "sketch.h"
+
+struct dump {
+  bool valid = false;
+  uint16_t dropped = 0;
+  uint32_t time = 0;
+  std::vector<traceEvent> events;
+};
+
+static uint16_t word(const std::string &data, size_t at) {
+  return (uint8_t)data[at] | ((uint8_t)data[at + 1] << 8);
+}
+
+// what dumpTrace() writes, read back
+static dump readDump() {
+  simSerialOutput.clear();
+  dumpTrace();
+  const std::string &data = simSerialOutput;
+  dump result;
+  if ((data.size() < 12) || (data[0] != 'T') || (data[1] != 'R') || (data[2] != TRACE_FORMAT_VERSION) || (data[3] != 6))
+    return result;
+
+  uint16_t count = word(data, 4);
+  if (data.size() != 12 + 6 * (size_t)count)
+    return result;
+  result.dropped = word(data, 6);
+  result.time = word(data, 8) | ((uint32_t)word(data, 10) << 16);
+  for (uint16_t i = 0; i < count; i++) {
+    size_t at = 12 + 6 * i;
+    traceEvent event = {word(data, at), (uint8_t)data[at + 2], (uint8_t)data[at + 3], word(data, at + 4)};
+    result.events.push_back(event);
+  }
+  result.valid = true;
+  return result;
+}
+
+static void clearTrace() {
+  traceNext = 0;
+  traceCount = 0;
+  traceDropped = 0;
+  traceClockKnown = false;
+}
+
+TEST(dumpHeaderAndEvents) {
+  simPowerOn();
+  clearTrace();
+  simAdvance(70000000 - simMicros); // millis() past 65535
+  trace(TRACE_KEY_PRESS, 0, 0x1234);
+  trace(TRACE_LAYOUT, 2, 0);
+
+  dump d = readDump();
+  CHECK(d.valid);
+  CHECK_EQUAL(70000, d.time);
+  CHECK_EQUAL(0, d.dropped);
+  CHECK_EQUAL(3, d.events.size());
+  if (d.events.size() == 3) {
+    CHECK_EQUAL(TRACE_CLOCK, d.events[0].type);
+    CHECK_EQUAL(70000 >> 16, d.events[0].value);
+    CHECK_EQUAL(70000 & 0xFFFF, d.events[1].time);
+    CHECK_EQUAL(TRACE_KEY_PRESS, d.events[1].type);
+    CHECK_EQUAL(0x1234, d.events[1].value);
+    CHECK_EQUAL(TRACE_LAYOUT, d.events[2].type);
+    CHECK_EQUAL(2, d.events[2].arg);
+  }
+}
+
+TEST(clockIsRecordedWhenItsHighBitsChange) {
+  simPowerOn();
+  clearTrace();
+  trace(TRACE_LAYOUT, 0, 0);
+  simAdvance(65536000UL);
+  trace(TRACE_LAYOUT, 1, 0);
+
+  dump d = readDump();
+  CHECK_EQUAL(4, d.events.size());
+  if (d.events.size() == 4) {
+    CHECK_EQUAL(TRACE_CLOCK, d.events[2].type);
+    CHECK_EQUAL(1, d.events[2].value);
+  }
+}
+
+TEST(oldEventsAreOverwritten) {
+  simPowerOn();
+  clearTrace();
+  for (uint16_t i = 0; i < TRACE_SIZE + 10; i++) {
+    trace(TRACE_KEY_PRESS, 0, i);
+  }
+
+  dump d = readDump();
+  CHECK_EQUAL(TRACE_SIZE, d.events.size());
+  CHECK_EQUAL(11, d.dropped); // the clock event and the first 10 presses
+  if (!d.events.empty()) {
+    CHECK_EQUAL(10, d.events.front().value); // oldest first
+    CHECK_EQUAL(TRACE_SIZE + 9, d.events.back().value);
+  }
+}
+
+TEST(inputsAndOutputsAreTraced) {
+  simPowerOn();
+  simRunUntil(1000000);
+  clearTrace();
+  simSchedulePress(simMicros + 1000, BUTTON_MIDDLE, 50000);
+  simScheduleDetents(simMicros + 100000, -2, 20000);
+  simRunUntil(simMicros + 300000);
+
+  std::vector<uint8_t> types;
+  for (const traceEvent &event : readDump().events) {
+    if (event.type != TRACE_CLOCK)
+      types.push_back(event.type);
+  }
+  CHECK(std::count(types.begin(), types.end(), TRACE_BUTTON_DOWN) == 1);
+  CHECK(std::count(types.begin(), types.end(), TRACE_BUTTON_UP) == 1);
+  CHECK(std::count(types.begin(), types.end(), TRACE_DETENTS) >= 1);
+  CHECK(std::count(types.begin(), types.end(), TRACE_KEY_PRESS) >= 2);
+  CHECK(!types.empty() && (types.front() == TRACE_BUTTON_DOWN));
+}
+
+TEST(dumpCommand) {
+  simPowerOn();
+  simSerialOutput.clear();
+  simSerialSend("t");
+  simRunUntil(simMicros + 10000);
+  CHECK(simSerialOutput.compare(0, 2, "TR") == 0);
+}
@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+"""
+Encode control modes into the binary mode image stored in the controller's
+EEPROM, and optionally upload it over the controller's serial port.
+
+The image format is described in mode_storage.h. Limits such as
+MAX_LABEL_LENGTH and the mouse action bits are read from the sketch's own
+headers, so they always match the firmware.
+
+Modes are described in JSON (modes.example.json holds the built-in modes of
+control_modes.h, written this way):
+
+  {"modes": [
+    {"name": "Media", "wheel": "Volume",
+     "left":   {"name": "Prev\\n<<", "keys": ["CONSUMER:HID_CONSUMER_SCAN_PREVIOUS_TRACK"]},
+     "wheelCW": {"name": "-", "keys": ["CONSUMER:MEDIA_VOLUME_DOWN"], "long": false},
+     "accelCurve": [[0, 100], [15, 100], [40, 200]]}
+  ]}
+
+Actions are left, right, middle, wheelCW, wheelCCW, wheelCWAccel and
+wheelCCWAccel; any that are left out are unbound. Keys are written as
+TYPE:CODE where TYPE is KEYBOARD, CONSUMER or MOUSE and CODE is a name from
+the tables below (or a MOUSE_* name from control_mode_structs.h) or a number.
+MACRO:n plays macro n of the firmware's built-in macroList.
+
+Usage:
+  encode_modes.py modes.json -o modes.bin
+  encode_modes.py modes.json --port /dev/ttyACM0   (needs pyserial)
+  encode_modes.py --erase --port /dev/ttyACM0
+
+Uploading and erasing need the firmware built with ENABLE_MODE_UPLOAD.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+SKETCH_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+
+IMAGE_VERSION = 1
+HEADER_SIZE = 8
+EEPROM_SIZE = 1024  # ATmega32u4
+
+ACTION_SLOTS = ["left", "right", "middle", "wheelCW", "wheelCCW", "wheelCWAccel", "wheelCCWAccel"]
+
+# from HID-Project's ImprovedKeylayouts.h
+KEYBOARD_KEYS = {
+    "KEY_ENTER": 0x28, "KEY_ESC": 0x29, "KEY_BACKSPACE": 0x2A, "KEY_TAB": 0x2B,
+    "KEY_SPACE": 0x2C, "KEY_MINUS": 0x2D, "KEY_EQUAL": 0x2E, "KEY_LEFT_BRACE": 0x2F,
+    "KEY_RIGHT_BRACE": 0x30, "KEY_PRINTSCREEN": 0x46, "KEY_SCROLL_LOCK": 0x47,
+    "KEY_PAUSE": 0x48, "KEY_INSERT": 0x49, "KEY_HOME": 0x4A, "KEY_PAGE_UP": 0x4B,
+    "KEY_DELETE": 0x4C, "KEY_END": 0x4D, "KEY_PAGE_DOWN": 0x4E, "KEY_RIGHT_ARROW": 0x4F,
+    "KEY_LEFT_ARROW": 0x50, "KEY_DOWN_ARROW": 0x51, "KEY_UP_ARROW": 0x52,
+    "KEY_LEFT_CTRL": 0xE0, "KEY_LEFT_SHIFT": 0xE1, "KEY_LEFT_ALT": 0xE2, "KEY_LEFT_GUI": 0xE3,
+    "KEY_RIGHT_CTRL": 0xE4, "KEY_RIGHT_SHIFT": 0xE5, "KEY_RIGHT_ALT": 0xE6, "KEY_RIGHT_GUI": 0xE7,
+}
+KEYBOARD_KEYS.update({"KEY_" + chr(ord("A") + i): 0x04 + i for i in range(26)})
+KEYBOARD_KEYS.update({"KEY_%d" % ((i + 1) % 10): 0x1E + i for i in range(10)})
+KEYBOARD_KEYS.update({"KEY_F%d" % (i + 1): 0x3A + i for i in range(12)})
+
+# from HID-Project's ConsumerAPI.h
+CONSUMER_KEYS = {
+    "CONSUMER_BRIGHTNESS_UP": 0x6F, "CONSUMER_BRIGHTNESS_DOWN": 0x70,
+    "MEDIA_FAST_FORWARD": 0xB3, "MEDIA_REWIND": 0xB4,
+    "MEDIA_NEXT": 0xB5, "HID_CONSUMER_SCAN_NEXT_TRACK": 0xB5,
+    "MEDIA_PREVIOUS": 0xB6, "HID_CONSUMER_SCAN_PREVIOUS_TRACK": 0xB6,
+    "MEDIA_STOP": 0xB7, "MEDIA_PLAY_PAUSE": 0xCD, "MEDIA_VOLUME_MUTE": 0xE2,
+    "MEDIA_VOLUME_UP": 0xE9, "MEDIA_VOLUME_DOWN": 0xEA,
+    "CONSUMER_BROWSER_HOME": 0x223, "CONSUMER_BROWSER_BACK": 0x224,
+    "CONSUMER_BROWSER_FORWARD": 0x225, "CONSUMER_BROWSER_REFRESH": 0x227,
+}
+
+
+class ModeError(Exception):
+    pass
+
+
+def read_defines(*filenames):
+    """Numeric #defines from the sketch headers, with references to earlier
+    defines resolved"""
+    defines = {}
+    for filename in filenames:
+        with open(os.path.join(SKETCH_DIR, filename)) as f:
+            for line in f:
+                match = re.match(r"\s*#define\s+(\w+)\s+([^/]+?)\s*(//.*)?$", line)
+                if not match:
+                    continue
+                try:
+                    defines[match.group(1)] = eval(match.group(2), {"__builtins__": {}}, defines)
+                except Exception:
+                    pass  # not a number
+    return defines
+
+
+def crc16(data):
+    """avr-libc _crc16_update(), starting from 0xFFFF"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+class Encoder:
+    def __init__(self):
+        self.defines = read_defines("config.h", "control_mode_structs.h", "display.h")
+
+    def define(self, name):
+        if name not in self.defines:
+            raise ModeError("%s not found in the sketch headers" % name)
+        return self.defines[name]
+
+    def label(self, text, where):
+        data = text.encode("ascii")
+        if len(data) >= self.define("MAX_LABEL_LENGTH"):
+            raise ModeError("%s: label %r is longer than %d characters"
+                            % (where, text, self.define("MAX_LABEL_LENGTH") - 1))
+        return struct.pack("<B", len(data)) + data
+
+    def key(self, key, where):
+        if ":" not in key:
+            raise ModeError("%s: key %r should be TYPE:CODE" % (where, key))
+        hid_type, code = key.split(":", 1)
+        tables = {"KEYBOARD": KEYBOARD_KEYS, "CONSUMER": CONSUMER_KEYS, "MOUSE": self.defines, "MACRO": {}}
+        if hid_type not in tables:
+            raise ModeError("%s: unknown key type %r" % (where, hid_type))
+
+        if code in tables[hid_type]:
+            value = tables[hid_type][code]
+        else:
+            try:
+                value = int(code, 0)
+            except ValueError:
+                raise ModeError("%s: unknown %s key %r" % (where, hid_type, code))
+
+        limit = 0xFF if hid_type == "KEYBOARD" else self.define("KEY_CODE_MASK")
+        if not (0 if hid_type == "MACRO" else 1) <= value <= limit:
+            raise ModeError("%s: key code %r out of range" % (where, key))
+        if hid_type == "MOUSE":
+            bits = value & self.define("MOUSE_ACTION_BITS")
+            hires = value & self.define("MOUSE_HIRES")
+            scrolls = bits & (self.define("MOUSE_SCROLL_POSITIVE") | self.define("MOUSE_SCROLL_NEGATIVE"))
+            if value & ~(self.define("MOUSE_EVENT") | bits | hires) or not value & self.define("MOUSE_EVENT") \
+                    or bits == 0 or bits & (bits - 1) or (hires and not scrolls):
+                raise ModeError("%s: %r is not exactly one MOUSE_* action" % (where, key))
+
+        return (self.define(hid_type + "_HID_TYPE") << self.define("HID_TYPE_SHIFT")) | value
+
+    def action(self, action, where):
+        keys = [self.key(k, where) for k in action.get("keys", [])]
+        if len(keys) > self.define("MAX_KEYS_PER_ACTION"):
+            raise ModeError("%s: more than %d keys" % (where, self.define("MAX_KEYS_PER_ACTION")))
+        mode_mask = self.define("LONG_KEY_DOWN_TIME") if action.get("long") else 0
+        return (self.label(action.get("name", ""), where)
+                + struct.pack("<BB", mode_mask, len(keys))
+                + b"".join(struct.pack("<H", k) for k in keys))
+
+    def wheel_labels(self, mode, where):
+        """Check that the wheel texts updateDisplay() builds fit a display field"""
+        if not mode.get("wheel"):
+            return
+        for cw, ccw in (("wheelCW", "wheelCCW"), ("wheelCWAccel", "wheelCCWAccel")):
+            text = "%s %s %s" % (mode.get(cw, {}).get("name", ""), mode["wheel"], mode.get(ccw, {}).get("name", ""))
+            if len(text) >= self.define("MAX_FIELD_LENGTH"):
+                raise ModeError("%s: wheel label %r is longer than %d characters"
+                                % (where, text, self.define("MAX_FIELD_LENGTH") - 1))
+
+    def mode(self, mode, index):
+        where = "mode %d (%s)" % (index, mode.get("name", "?"))
+        if "name" not in mode:
+            raise ModeError("%s: name is required" % where)
+        unknown = set(mode) - set(ACTION_SLOTS) - {"name", "wheel", "accelCurve"}
+        if unknown:
+            raise ModeError("%s: unknown fields %s" % (where, ", ".join(sorted(unknown))))
+
+        data = self.label(mode["name"], where) + self.label(mode.get("wheel", ""), where)
+        self.wheel_labels(mode, where)
+        for slot in ACTION_SLOTS:
+            data += self.action(mode.get(slot, {}), "%s %s" % (where, slot))
+
+        curve = mode.get("accelCurve", [])
+        if len(curve) > self.define("ACCEL_CURVE_POINTS"):
+            raise ModeError("%s: more than %d curve points" % (where, self.define("ACCEL_CURVE_POINTS")))
+        data += struct.pack("<B", len(curve))
+        for speed, percent in curve:
+            data += struct.pack("<HH", speed, percent)
+        return data
+
+    def image(self, modes):
+        if not 0 < len(modes) < 256:
+            raise ModeError("need between 1 and 255 modes")
+
+        records = [self.mode(mode, i) for i, mode in enumerate(modes)]
+        offset = HEADER_SIZE + 2 * len(records)
+        table = b""
+        for record in records:
+            table += struct.pack("<H", offset)
+            offset += len(record)
+        body = table + b"".join(records)
+
+        length = HEADER_SIZE + len(body)
+        # a slot byte, then two slots so the old image is kept until the new one is in
+        capacity = (EEPROM_SIZE - 1 - self.define("MODE_IMAGE_ADDRESS")) // 2
+        if length > capacity:
+            raise ModeError("image is %d bytes, only %d fit in an EEPROM slot" % (length, capacity))
+
+        return b"SW" + struct.pack("<BBHH", IMAGE_VERSION, len(records), length, crc16(body)) + body
+
+
+def send_command(port, command, timeout):
+    import serial  # pyserial
+
+    with serial.Serial(port, timeout=timeout) as connection:
+        connection.reset_input_buffer()
+        connection.write(command)
+        while True:
+            line = connection.readline().decode("ascii", "replace").strip()
+            if not line:
+                raise ModeError("no answer from the controller")
+            if line.startswith("OK") or line.startswith("ERR"):
+                return line
+            # anything else is debugging output
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode control modes for the controller's EEPROM")
+    parser.add_argument("modes", nargs="?", help="JSON mode description")
+    parser.add_argument("-o", "--output", help="write the image to this file")
+    parser.add_argument("--port", help="upload to the controller on this serial port")
+    parser.add_argument("--erase", action="store_true",
+                        help="erase the image on the controller, going back to the built-in modes")
+    args = parser.parse_args()
+
+    try:
+        if args.erase:
+            if not args.port:
+                parser.error("--erase needs --port")
+            print(send_command(args.port, b"xSW", 5))
+            return 0
+
+        if not args.modes:
+            parser.error("a mode description is required")
+        with open(args.modes) as f:
+            image = Encoder().image(json.load(f)["modes"])
+        print("%d byte image" % len(image))
+
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(image)
+        if args.port:
+            # the controller writes about one EEPROM byte every 3.4ms
+            answer = send_command(args.port, b"uSW" + struct.pack("<HH", len(image), crc16(image)) + image,
+                                  5 + len(image) * 0.004)
+            print(answer)
+            if not answer.startswith("OK"):
+                return 1
+    except ModeError as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
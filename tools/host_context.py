@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+Stand-in for a host agent that keeps the controller in the right control
+mode, using the 'm' and 'l' serial commands (see serial_commands.h).
+
+Usage (needs pyserial):
+  host_context.py --port /dev/ttyACM0 mode VLC       select a mode by name
+  host_context.py --port /dev/ttyACM0 mode 2         ... or by index
+  host_context.py --port /dev/ttyACM0 label "Build ok"
+  host_context.py --port /dev/ttyACM0 label ""       remove the label
+  some-window-watcher | host_context.py --port /dev/ttyACM0 follow
+
+`follow` reads one application name per line from stdin and selects the mode
+it maps to, given as --map APPLICATION=MODE (repeatable); applications
+without a mapping select the mode of the same name, if there is one. The
+label is set to the application name as a reminder of why the mode changed.
+"""
+
+import argparse
+import sys
+
+import serial  # pyserial
+
+
+def command(connection, text):
+    """Send one command line and return the controller's answer"""
+    connection.write(text.encode("ascii") + b"\n")
+    while True:
+        line = connection.readline().decode("ascii", "replace").strip()
+        if not line:
+            return "ERR no answer"
+        if line.startswith("OK") or line.startswith("ERR"):
+            return line
+        # anything else is debugging output
+
+
+def follow(connection, mapping):
+    current = None
+    for line in sys.stdin:
+        application = line.strip()
+        if not application or application == current:
+            continue
+        current = application
+
+        answer = command(connection, "m" + mapping.get(application, application))
+        print("%s: %s" % (application, answer))
+        if answer.startswith("OK"):
+            command(connection, "l" + application)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Select the controller's mode from the host")
+    parser.add_argument("--port", required=True, help="serial port of the controller")
+    parser.add_argument("--map", action="append", default=[], metavar="APPLICATION=MODE",
+                        help="mode to select for an application, for follow")
+    parser.add_argument("action", choices=["mode", "label", "follow"])
+    parser.add_argument("value", nargs="?", default="")
+    args = parser.parse_args()
+
+    with serial.Serial(args.port, timeout=2) as connection:
+        connection.reset_input_buffer()
+        if args.action == "mode":
+            answer = command(connection, "m" + args.value)
+        elif args.action == "label":
+            answer = command(connection, "l" + args.value)
+        else:
+            follow(connection, dict(m.split("=", 1) for m in args.map))
+            return 0
+
+    print(answer)
+    return 0 if answer.startswith("OK") else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
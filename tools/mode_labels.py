@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+Collect the labels of the built-in control modes into mode_labels.h, the
+table they are stored in (see modeLabel in control_mode_structs.h).
+
+Every distinct label in control_modes.h (mode, wheel and action names, in the
+mode list and the gesture bindings) is stored once, with its terminator, in
+a single PROGMEM string. The modes refer to their labels by offset, found
+in the table when compiling, so a label costs its own length instead of
+MAX_LABEL_LENGTH bytes, and a label used by several modes costs nothing
+after the first.
+
+Run it again after changing the labels in control_modes.h; a label missing
+from the table is a compile error.
+"""
+
+import os
+import re
+import sys
+
+SKETCH_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+INPUT = "control_modes.h"
+OUTPUT = "mode_labels.h"
+
+# from config.h
+MAX_LABEL_LENGTH = 11
+
+
+def strip_comments(source):
+    """The source without comments and preprocessor lines"""
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    source = re.sub(r"//[^\n]*", "", source)
+    return re.sub(r"^\s*#[^\n]*", "", source, flags=re.M)
+
+
+def c_string(literal):
+    return literal.encode("ascii").decode("unicode_escape")
+
+
+def c_literal(text):
+    escaped = text.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+    return '"%s\\0"' % escaped
+
+
+def read_labels():
+    """Every string literal in control_modes.h, in order of first use"""
+    with open(os.path.join(SKETCH_DIR, INPUT)) as f:
+        source = strip_comments(f.read())
+    labels = []
+    for literal in re.findall(r'"((?:\\.|[^"\\])*)"', source):
+        label = c_string(literal)
+        if len(label) >= MAX_LABEL_LENGTH:
+            sys.exit("error: label %r is longer than %d characters" % (label, MAX_LABEL_LENGTH - 1))
+        if label and label not in labels:
+            labels.append(label)
+    return labels
+
+
+def main():
+    labels = read_labels()
+
+    out = ["// Generated by tools/mode_labels.py from control_modes.h; do not edit",
+           "#ifndef MODE_LABELS_H",
+           "#define MODE_LABELS_H",
+           "",
+           "// the empty label first, at offset 0",
+           "constexpr char modeLabels[] PROGMEM =",
+           '  "\\0"']
+    out += ["  " + c_literal(label) for label in labels]
+    out[-1] += ";"
+    out.append("")
+    out.append("#endif")
+
+    with open(os.path.join(SKETCH_DIR, OUTPUT), "w") as f:
+        f.write("\n".join(out) + "\n")
+    size = 1 + sum(len(label) + 1 for label in labels) + 1
+    print("%d labels, %d bytes written to %s" % (len(labels), size, OUTPUT))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
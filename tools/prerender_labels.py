@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""
+Pre-render the display text of the built-in control modes into bitmaps, so
+the controller can copy them straight into display memory instead of drawing
+them glyph by glyph (see ENABLE_PRERENDERED_LABELS in config.h).
+
+Every line the display can show for the modes in control_modes.h is
+rendered: mode, action and wheel names, and the combined wheel and
+quick-toggle texts that updateDisplay() builds from them. Each line is
+rendered once per font, exactly as SSD1306Ascii's write() would draw it,
+and written to prerendered_labels.h in the sketch directory.
+
+Lines the controller shows that are not in the table (modes uploaded to
+EEPROM, labels sent by the host, the screensaver) are drawn with the font as
+before, and so are the lines of a mode that was changed without running this
+again.
+
+Fonts are read from their GLCDFONTDECL headers. fonts/font8x8_custom.h is
+always rendered; fonts from the SSD1306Ascii library, such as the Arial14 of
+the second layout, are added with --font:
+
+  prerender_labels.py
+  prerender_labels.py --font ~/Arduino/libraries/SSD1306Ascii/src/fonts/Arial14.h
+
+Run it again after changing the control modes or the layouts.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+SKETCH_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+OUTPUT = "prerendered_labels.h"
+DEFAULT_FONTS = [os.path.join("fonts", "font8x8_custom.h")]
+DISPLAY_WIDTH = 128
+
+# order of the fields of struct controlMode after the two names
+ACTION_FIELDS = ["left", "right", "middle", "wheelCW", "wheelCCW", "wheelCWAccel", "wheelCCWAccel"]
+
+
+class Font:
+    def __init__(self, name, data):
+        self.name = name
+        self.fixed = ((data[0] << 8) | data[1]) < 2
+        self.width = data[2]
+        self.height = data[3]
+        self.first = data[4]
+        self.count = data[5]
+        self.rows = (self.height + 7) // 8
+        if self.fixed:
+            self.widths = [self.width] * self.count
+            self.glyphs = data[6:]
+            self.letter_spacing = 0
+            self.shift = 0
+        else:
+            self.widths = data[6:6 + self.count]
+            self.glyphs = data[6 + self.count:]
+            self.letter_spacing = 1
+            # the bottom row of proportional fonts is aligned to the bottom of its byte
+            self.shift = (8 - self.height % 8) % 8 if self.height > 8 else 0
+
+    def has(self, char):
+        return self.first <= ord(char) < self.first + self.count
+
+    def render(self, text):
+        """The bitmap of text, one display row after the other"""
+        rows = [[] for _ in range(self.rows)]
+        for char in text:
+            index = ord(char) - self.first
+            width = self.widths[index]
+            offset = self.rows * sum(self.widths[:index])
+            for row in range(self.rows):
+                for col in range(width):
+                    byte = self.glyphs[offset + col + row * width]
+                    if self.shift and row == self.rows - 1:
+                        byte >>= self.shift
+                    rows[row].append(byte)
+                rows[row].extend([0] * self.letter_spacing)
+        return rows
+
+
+def strip_comments(source):
+    source = re.sub(r"/\*.*?\*/", "", source, flags=re.S)
+    return re.sub(r"//[^\n]*", "", source)
+
+
+def read_font(path):
+    with open(path) as f:
+        source = strip_comments(f.read())
+    match = re.search(r"GLCDFONTDECL\s*\(\s*(\w+)\s*\)\s*=\s*\{(.*?)\}", source, re.S)
+    if not match:
+        sys.exit("error: no GLCDFONTDECL in %s" % path)
+    data = [int(value, 0) for value in re.findall(r"0[xX][0-9a-fA-F]+|0[bB][01]+|[1-9]\d*|0", match.group(2))]
+    return Font(match.group(1), data)
+
+
+def c_string(literal):
+    return literal.encode("ascii").decode("unicode_escape")
+
+
+def read_modes():
+    """(name, wheelName, {action: label}) of every mode in controlModeList"""
+    with open(os.path.join(SKETCH_DIR, "control_modes.h")) as f:
+        source = strip_comments(f.read())
+    start = re.search(r"controlModeList\s*\[\s*\]\s*PROGMEM\s*=\s*\{", source)
+    if not start:
+        sys.exit("error: controlModeList not found in control_modes.h")
+
+    # walk the initializer: depth 1 is a mode, depth 2 one of its fields
+    modes = []
+    fields = None
+    depth = 1
+    for token in re.finditer(r'"(?:\\.|[^"\\])*"|[{}]', source[start.end():]):
+        token = token.group(0)
+        if token == "{":
+            depth += 1
+            if depth == 2:
+                fields = []
+            elif depth == 3:
+                fields.append(None)
+        elif token == "}":
+            depth -= 1
+            if depth == 1:
+                modes.append(fields)
+            elif depth == 0:
+                break
+        elif depth == 3 and fields[-1] is None:
+            fields[-1] = c_string(token[1:-1])
+
+    result = []
+    for fields in modes:
+        labels = [label or "" for label in fields[:2 + len(ACTION_FIELDS)]]
+        labels += [""] * (2 + len(ACTION_FIELDS) - len(labels))
+        result.append((labels[0], labels[1], dict(zip(ACTION_FIELDS, labels[2:]))))
+    return result
+
+
+def display_texts(modes):
+    """Every text updateDisplay() can build for these modes"""
+    texts = {"--"}
+    for name, wheel, actions in modes:
+        texts.add(name)
+        texts.update(actions[action] for action in ("left", "right", "middle"))
+        if wheel:
+            texts.add("%s %s %s" % (actions["wheelCW"], wheel, actions["wheelCCW"]))
+            texts.add("%s %s %s" % (actions["wheelCWAccel"], wheel, actions["wheelCCWAccel"]))
+        texts.add(name + " ->")
+        texts.add("<- " + name)
+    return texts
+
+
+def c_literal(text):
+    return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pre-render the built-in mode labels for the display")
+    parser.add_argument("--font", action="append", default=[],
+                        help="also render with the font in this GLCDFONTDECL header")
+    args = parser.parse_args()
+
+    fonts = [read_font(os.path.join(SKETCH_DIR, path)) for path in DEFAULT_FONTS]
+    fonts += [read_font(os.path.expanduser(path)) for path in args.font]
+
+    lines = set()
+    for text in display_texts(read_modes()):
+        lines.update(line for line in text.split("\n") if line)
+
+    out = ["// Generated by tools/prerender_labels.py; do not edit",
+           "#ifndef PRERENDERED_LABELS_H",
+           "#define PRERENDERED_LABELS_H",
+           ""]
+    out += ['#include "%s"' % path.replace(os.sep, "/") for path in DEFAULT_FONTS]
+    out.append("")
+    entries = []
+    total = 0
+    for font in fonts:
+        for line in sorted(lines):
+            if not all(font.has(char) for char in line):
+                continue
+            rows = font.render(line)
+            width = len(rows[0])
+            if width > DISPLAY_WIDTH:
+                continue  # wider than the display; left to the font path, which clips
+            n = len(entries)
+            out.append("// %s, %s" % (font.name, c_literal(line)))
+            out.append("const char prerenderedText%d[] PROGMEM = %s;" % (n, c_literal(line)))
+            out.append("const uint8_t prerenderedBitmap%d[] PROGMEM = {" % n)
+            for row in rows:
+                out.append("  " + ", ".join("0x%02X" % byte for byte in row) + ",")
+            out.append("};")
+            entries.append("  {%s, prerenderedText%d, prerenderedBitmap%d, %d, %d}," % (font.name, n, n, len(line), width))
+            total += width * font.rows
+
+    out.append("")
+    out.append("const prerenderedLabel prerenderedLabels[] PROGMEM = {")
+    out.extend(entries)
+    out.append("};")
+    out.append("")
+    out.append("#endif")
+
+    with open(os.path.join(SKETCH_DIR, OUTPUT), "w") as f:
+        f.write("\n".join(out) + "\n")
+    print("%d lines, %d bitmap bytes written to %s" % (len(entries), total, OUTPUT))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""
+Fetch, decode and compare the event traces recorded by the controller with
+ENABLE_TRACE (see trace.h, which also describes the dump format). Event types
+and button numbers are read from trace.h, so they always match the firmware.
+
+Usage:
+  trace.py --port /dev/ttyACM0 -o field.trace   fetch a dump (needs pyserial)
+  trace.py field.trace                          print its events
+  trace.py --diff before.trace after.trace      compare the HID output
+  trace.py --inputs field.trace                 print the inputs as a replay script
+
+--diff lines up the HID output (presses, releases and scrolls, without
+times) of two dumps of the same inputs, e.g. from firmware before and after
+a change, and prints where they differ.
+
+--inputs prints one input per line, with its time relative to the first:
+
+  <ms> button <middle|up|down|left|right> <down|up>
+  <ms> detents <n>
+
+for tests/host/replay to play back on the simulated board, which sets the
+button pins and turns the encoder pins (decoded by decodeEncoder()) at those
+times and writes a trace of its own to --diff against the original:
+
+  trace.py --inputs field.trace > field.inputs
+  tests/host/build/replay field.inputs replayed.trace
+  trace.py --diff field.trace replayed.trace
+"""
+
+import argparse
+import difflib
+import os
+import re
+import struct
+import sys
+
+SKETCH_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+
+HEADER = struct.Struct("<2sBBHHI")
+EVENT = struct.Struct("<HBBH")
+
+HID_TYPE_SHIFT = 14
+HID_TYPES = ["KEYBOARD", "CONSUMER", "MOUSE", "MACRO"]
+
+
+class TraceError(Exception):
+    pass
+
+
+def read_trace_defines():
+    """The format version, and the event types and button numbers as
+    {number: name}, from trace.h"""
+    version, events, buttons = None, {}, {}
+    with open(os.path.join(SKETCH_DIR, "trace.h")) as f:
+        for line in f:
+            match = re.match(r"\s*#define\s+TRACE_(\w+)\s+(\d+)", line)
+            if not match:
+                continue
+            name, number = match.group(1), int(match.group(2))
+            if name == "FORMAT_VERSION":
+                version = number
+            elif name.endswith("_BUTTON"):
+                buttons[number] = name[:-len("_BUTTON")].lower()
+            else:
+                events[number] = name
+    return version, events, buttons
+
+
+FORMAT_VERSION, EVENTS, BUTTONS = read_trace_defines()
+
+
+def signed(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def key_name(packed):
+    return "%s:0x%X" % (HID_TYPES[packed >> HID_TYPE_SHIFT], packed & ((1 << HID_TYPE_SHIFT) - 1))
+
+
+def parse(data):
+    """[(millis, type name, arg, value)] of a dump, oldest first"""
+    if len(data) < HEADER.size:
+        raise TraceError("dump too short")
+    magic, version, size, count, dropped, now = HEADER.unpack_from(data)
+    if magic != b"TR":
+        raise TraceError("not a trace dump")
+    if version != FORMAT_VERSION or size != EVENT.size:
+        raise TraceError("trace format %d with %d byte events; this tool reads format %d"
+                         % (version, size, FORMAT_VERSION))
+    if len(data) < HEADER.size + count * EVENT.size:
+        raise TraceError("dump truncated")
+    if dropped:
+        print("note: %d older events were overwritten" % dropped, file=sys.stderr)
+
+    raw = [EVENT.unpack_from(data, HEADER.size + i * EVENT.size) for i in range(count)]
+
+    # Events after a CLOCK event have its high 16 bits. Any before the first
+    # one (it may have been overwritten) are placed going back from it, which
+    # is right as long as they are less than 65.5s apart.
+    times = [None] * count
+    high = None
+    for i, (time, kind, arg, value) in enumerate(raw):
+        if EVENTS.get(kind) == "CLOCK":
+            high = value
+        if high is not None:
+            times[i] = (high << 16) | time
+    first = next((i for i, t in enumerate(times) if t is not None), count)
+    later = times[first] if first < count else now
+    for i in reversed(range(first)):
+        times[i] = later - ((later - raw[i][0]) & 0xFFFF)
+        later = times[i]
+
+    return [(times[i], EVENTS.get(kind, "UNKNOWN_%d" % kind), arg, value)
+            for i, (_, kind, arg, value) in enumerate(raw) if EVENTS.get(kind) != "CLOCK"]
+
+
+def describe(kind, arg, value):
+    if kind in ("BUTTON_DOWN", "BUTTON_UP"):
+        return "button %s %s" % (BUTTONS.get(arg, arg), kind[len("BUTTON_"):].lower())
+    if kind == "DETENTS":
+        return "detents %d" % signed(value)
+    if kind in ("KEY_PRESS", "KEY_RELEASE"):
+        return "%s %s" % (kind[len("KEY_"):].lower(), key_name(value))
+    if kind == "RELEASE_ALL":
+        return "release all" + (" keyboard" if arg & 1 else "") + (" consumer" if arg & 2 else "")
+    if kind == "SCROLL":
+        return "scroll%s %d" % (" hi-res" if arg else "", signed(value))
+    if kind == "MODE":
+        return "mode %d (from %d)" % (arg, value)
+    if kind == "LAYOUT":
+        return "layout %d" % arg
+    return "%s arg=%d value=%d" % (kind, arg, value)
+
+
+def hid_output(events):
+    return [describe(kind, arg, value) for _, kind, arg, value in events
+            if kind in ("KEY_PRESS", "KEY_RELEASE", "RELEASE_ALL", "SCROLL")]
+
+
+def fetch(port):
+    import serial  # pyserial
+
+    with serial.Serial(port, timeout=2) as connection:
+        connection.reset_input_buffer()
+        connection.write(b"t")
+        # skip anything printed before the dump, e.g. debugging output
+        data = b""
+        while b"TR" not in data:
+            byte = connection.read(1)
+            if not byte:
+                raise TraceError("no answer from the controller")
+            data = (data + byte)[-2:]
+        header = data + connection.read(HEADER.size - 2)
+        count = HEADER.unpack(header)[3]
+        body = connection.read(count * EVENT.size)
+        return header + body
+
+
+def load(filename):
+    with open(filename, "rb") as f:
+        return f.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fetch and decode controller event traces")
+    parser.add_argument("traces", nargs="*", help="trace dumps")
+    parser.add_argument("--port", help="fetch a dump from the controller on this serial port")
+    parser.add_argument("-o", "--output", help="where to save the fetched dump")
+    parser.add_argument("--diff", action="store_true", help="compare the HID output of two dumps")
+    parser.add_argument("--inputs", action="store_true", help="print the inputs as a script for tests/host/replay")
+    args = parser.parse_args()
+
+    try:
+        if args.port:
+            data = fetch(args.port)
+            if args.output:
+                with open(args.output, "wb") as f:
+                    f.write(data)
+            dumps = [data]
+        else:
+            dumps = [load(filename) for filename in args.traces]
+        if not dumps:
+            parser.error("give a trace dump or --port")
+
+        if args.diff:
+            if len(dumps) != 2:
+                parser.error("--diff needs two trace dumps")
+            before, after = (hid_output(parse(data)) for data in dumps)
+            diff = list(difflib.unified_diff(before, after, args.traces[0], args.traces[1], lineterm=""))
+            print("\n".join(diff) if diff else "HID output is the same")
+            return 1 if diff else 0
+
+        for data in dumps:
+            events = parse(data)
+            start = events[0][0] if events else 0
+            for time, kind, arg, value in events:
+                if args.inputs:
+                    if kind in ("BUTTON_DOWN", "BUTTON_UP", "DETENTS"):
+                        print("%d %s" % (time - start, describe(kind, arg, value)))
+                else:
+                    print("%10d  %s" % (time, describe(kind, arg, value)))
+    except TraceError as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
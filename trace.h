@@ -0,0 +1,150 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "config.h"
+
+/*
+Opt-in recorder of what goes in and out of the controller, enabled with
+ENABLE_TRACE in config.h, for reproducing problems seen in use.
+
+The last TRACE_SIZE events are kept in a ring buffer in RAM: button edges and
+batches of wheel detents going in, HID presses, releases and scrolls and
+mode and layout changes coming out. Send 't' over the serial port to dump
+them (see serial_commands.h); tools/trace.py decodes a dump, diffs the HID
+output of two dumps and turns the inputs into a script for tests/host/replay
+to play back on the simulated board.
+
+Dump format, little-endian:
+
+  'T', 'R', TRACE_FORMAT_VERSION, size of an event (6)
+  uint16 number of events that follow
+  uint16 number of older events that were overwritten
+  uint32 millis() at the time of the dump
+  the events, oldest first
+
+Each event is uint16 time, uint8 type, uint8 arg, uint16 value, where time
+is the low 16 bits of millis(). A TRACE_CLOCK event with the high 16 bits in
+value comes first, and again whenever they change.
+
+With tracing disabled trace() and traceButtons() are empty and compile to
+nothing.
+*/
+
+#define TRACE_FORMAT_VERSION 1
+
+#define TRACE_CLOCK 0 // value: millis() >> 16
+#define TRACE_BUTTON_DOWN 1 // arg: TRACE_*_BUTTON
+#define TRACE_BUTTON_UP 2 // arg: TRACE_*_BUTTON
+#define TRACE_DETENTS 3 // value: int16 detents taken from the encoder queue, negative is CCW
+#define TRACE_KEY_PRESS 4 // value: packed key (actionKeypress)
+#define TRACE_KEY_RELEASE 5 // value: packed key
+#define TRACE_RELEASE_ALL 6 // arg: bit 0 keyboard, bit 1 consumer
+#define TRACE_SCROLL 7 // arg: 1 if high-resolution; value: int16 amount
+#define TRACE_MODE 8 // arg: new mode index; value: previous mode index
+#define TRACE_LAYOUT 9 // arg: layout index
+
+// the same numbers as BUTTON_* in control_mode_structs.h
+#define TRACE_MIDDLE_BUTTON 0
+#define TRACE_UP_BUTTON 1
+#define TRACE_DOWN_BUTTON 2
+#define TRACE_LEFT_BUTTON 3
+#define TRACE_RIGHT_BUTTON 4
+
+#ifdef ENABLE_TRACE
+
+#include "buttons.h"
+
+static_assert((TRACE_SIZE > 0) && (TRACE_SIZE <= 255), "TRACE_SIZE must be 1 to 255");
+static_assert((TRACE_MIDDLE_BUTTON == BUTTON_MIDDLE) && (TRACE_UP_BUTTON == BUTTON_UP)
+              && (TRACE_DOWN_BUTTON == BUTTON_DOWN) && (TRACE_LEFT_BUTTON == BUTTON_LEFT)
+              && (TRACE_RIGHT_BUTTON == BUTTON_RIGHT), "TRACE_*_BUTTON must match BUTTON_*");
+
+struct traceEvent {
+  uint16_t time;
+  uint8_t type;
+  uint8_t arg;
+  uint16_t value;
+};
+
+traceEvent traceBuffer[TRACE_SIZE];
+uint8_t traceNext = 0; // where the next event goes
+uint8_t traceCount = 0;
+uint16_t traceDropped = 0;
+bool traceClockKnown = false;
+uint16_t traceClockHigh = 0;
+
+void traceStore(uint16_t time, uint8_t type, uint8_t arg, uint16_t value) {
+  traceEvent &event = traceBuffer[traceNext];
+  event.time = time;
+  event.type = type;
+  event.arg = arg;
+  event.value = value;
+
+  if (++traceNext >= TRACE_SIZE)
+    traceNext = 0;
+  if (traceCount < TRACE_SIZE) {
+    traceCount++;
+  } else if (traceDropped < 0xFFFF) {
+    traceDropped++;
+  }
+}
+
+// Record an event; only to be called from loop(), not from interrupts
+void trace(uint8_t type, uint8_t arg, uint16_t value) {
+  unsigned long now = millis();
+  uint16_t high = now >> 16;
+  if (!traceClockKnown || (high != traceClockHigh)) {
+    traceStore(now, TRACE_CLOCK, 0, high);
+    traceClockKnown = true;
+    traceClockHigh = high;
+  }
+  traceStore(now, type, arg, value);
+}
+
+// Record the button edges; to be called after readButtons()
+void traceButtons() {
+  uint8_t pending = buttonsPressed | buttonsReleased;
+  for (uint8_t b = 0; pending != 0; b++, pending >>= 1) {
+    if (pending & 1)
+      trace(bitRead(buttonsPressed, b) ? TRACE_BUTTON_DOWN : TRACE_BUTTON_UP, b, 0);
+  }
+}
+
+void writeTraceWord(uint16_t value) {
+  Serial.write(value & 0xFF);
+  Serial.write(value >> 8);
+}
+
+// Write the recorded events over the serial port, in the format above
+void dumpTrace() {
+  unsigned long now = millis();
+  Serial.write('T');
+  Serial.write('R');
+  Serial.write(TRACE_FORMAT_VERSION);
+  Serial.write(sizeof (traceEvent));
+  writeTraceWord(traceCount);
+  writeTraceWord(traceDropped);
+  writeTraceWord(now & 0xFFFF);
+  writeTraceWord(now >> 16);
+
+  uint8_t i = (traceNext + TRACE_SIZE - traceCount) % TRACE_SIZE;
+  for (uint8_t n = 0; n < traceCount; n++) {
+    traceEvent &event = traceBuffer[i];
+    writeTraceWord(event.time);
+    Serial.write(event.type);
+    Serial.write(event.arg);
+    writeTraceWord(event.value);
+    if (++i >= TRACE_SIZE)
+      i = 0;
+  }
+}
+
+#else
+
+// functions rather than empty macros, so `if (...) trace(...);` stays a whole statement
+inline void trace(uint8_t type, uint8_t arg, uint16_t value) {}
+inline void traceButtons() {}
+
+#endif
+
+#endif